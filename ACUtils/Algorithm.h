@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <cstdint>
 #include <vector>
 #include <type_traits>
 #include <iterator>
@@ -121,4 +122,38 @@ namespace Algorithm
 		return BINARY_SEARCH_INVALID_INDEX;
 	}
 
+	// LSD radix sort on an unsigned integer key, 8 bits per pass, stable. Only the low keyBits of the key get looked at,
+	// so small keys take fewer passes. Linear in the number of items.
+	template<typename T, typename KeyFunc>
+	void radix_sort_by_key(std::vector<T>& items, KeyFunc getKey, uint32_t keyBits = 32)
+	{
+		constexpr uint32_t RADIX_BITS = 8;
+		constexpr uint32_t RADIX_SIZE = 1 << RADIX_BITS;
+
+		std::vector<T> scratch(items.size());
+		for (uint32_t shift = 0; shift < keyBits; shift += RADIX_BITS)
+		{
+			size_t offsets[RADIX_SIZE] = { 0 };
+			for (const T& item : items)
+			{
+				++offsets[(getKey(item) >> shift) & (RADIX_SIZE - 1)];
+			}
+
+			size_t total = 0;
+			for (size_t& offset : offsets)
+			{
+				const size_t count = offset;
+				offset = total;
+				total += count;
+			}
+
+			for (const T& item : items)
+			{
+				scratch[offsets[(getKey(item) >> shift) & (RADIX_SIZE - 1)]++] = item;
+			}
+
+			items.swap(scratch);
+		}
+	}
+
 } // Algorithm
@@ -209,7 +209,7 @@ namespace Bits
 
 	constexpr uint32_t PopCount64(uint64_t value)
 	{
-		return (value == ~0UL) ? 64 : (uint32_t)__popcnt64(value);
+		return (value == ~0ULL) ? 64 : (uint32_t)__popcnt64(value);
 	}
 
 	inline uint32_t PopCount128(const Bitfield128& value)
@@ -355,5 +355,21 @@ namespace Bits
 			outIndex = 64 - outIndex;
 		}
 	}
+
+	// In place transpose of a 64 x 64 bit block, bit c of row r swaps with bit r of row c. Swaps 32 x 32 quadrants, then
+	// 16 x 16 blocks inside those, and so on down, so it's 6 passes of 32 masked swaps rather than 4096 single bits.
+	inline void Transpose64x64(uint64_t rows[64])
+	{
+		uint64_t mask = 0x00000000FFFFFFFFULL;
+		for (uint32_t width = 32; width != 0; width >>= 1, mask ^= mask << width)
+		{
+			for (uint32_t row = 0; row < 64; row = ((row | width) + 1) & ~width)
+			{
+				const uint64_t swapBits = ((rows[row] >> width) ^ rows[row | width]) & mask;
+				rows[row] ^= swapBits << width;
+				rows[row | width] ^= swapBits;
+			}
+		}
+	}
 } // Bits
 
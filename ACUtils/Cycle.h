@@ -0,0 +1,132 @@
+#pragma once
+
+#include <assert.h>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+// Period detection for anything of the form x_0 = start, x_(n + 1) = step(x_n) with a finite number of states. Sooner or
+// later that sequence loops, x_(mu + lambda) == x_mu, and from there any iteration maps back onto one we've already seen.
+namespace Cycle
+{
+	struct Result
+	{
+		uint64_t mu = 0; // Iterations before the loop starts.
+		uint64_t lambda = 0; // Loop length.
+
+		// The first iteration with the same state as iteration target.
+		uint64_t GetEquivalentIteration(uint64_t target) const
+		{
+			return (target < mu || lambda == 0) ? target : mu + (target - mu) % lambda;
+		}
+	};
+
+	// step(State&) moves the state forward one iteration in place.
+	template<typename State, typename StepFunc>
+	void Advance(State& inOutState, StepFunc step, uint64_t iterations)
+	{
+		for (uint64_t i = 0; i < iterations; ++i)
+		{
+			step(inOutState);
+		}
+	}
+
+	// State at iteration target, only simulating up to mu + lambda.
+	template<typename State, typename StepFunc>
+	void GetStateAt(const State& start, StepFunc step, const Result& cycle, uint64_t target, State& outState)
+	{
+		outState = start;
+		Advance(outState, step, cycle.GetEquivalentIteration(target));
+	}
+
+	// Given the state at the start of the loop (iteration mu), moves it to iteration target (>= mu) in under lambda steps.
+	template<typename State, typename StepFunc>
+	void AdvanceFromLoopStart(State& inOutLoopState, StepFunc step, const Result& cycle, uint64_t target)
+	{
+		assert(target >= cycle.mu);
+		Advance(inOutLoopState, step, cycle.GetEquivalentIteration(target) - cycle.mu);
+	}
+
+	// Both finders take the starting state in inOutState and, on success, leave it at the start of the loop (iteration mu)
+	// ready for AdvanceFromLoopStart. They return false if no loop shows up within maxIterations.
+
+	// Brent's algorithm. Never holds more than three states at once, at the cost of stepping roughly 2 * mu + 3 * lambda times.
+	template<typename State, typename StepFunc, typename EqualFunc = std::equal_to<State>>
+	bool FindBrent(State& inOutState, StepFunc step, Result& outResult, uint64_t maxIterations = ~0ULL, EqualFunc equal = EqualFunc())
+	{
+		const State& start = inOutState;
+
+		// Find lambda: the hare runs ahead in power of two sized legs, the tortoise teleports to it at the start of each.
+		uint64_t power = 1;
+		uint64_t lambda = 1;
+		uint64_t iterations = 1;
+		State tortoise = start;
+		State hare = start;
+		step(hare);
+		while (!equal(tortoise, hare))
+		{
+			if (iterations++ > maxIterations)
+			{
+				return false;
+			}
+
+			if (power == lambda)
+			{
+				tortoise = hare;
+				power *= 2;
+				lambda = 0;
+			}
+
+			step(hare);
+			++lambda;
+		}
+
+		// Find mu: with the hare lambda ahead, they first meet at the start of the loop.
+		uint64_t mu = 0;
+		tortoise = start;
+		hare = start;
+		Advance(hare, step, lambda);
+		while (!equal(tortoise, hare))
+		{
+			step(tortoise);
+			step(hare);
+			++mu;
+		}
+
+		outResult.mu = mu;
+		outResult.lambda = lambda;
+		inOutState = tortoise;
+		return true;
+	}
+
+	// Steps mu + lambda times, remembering only a 64 bit fingerprint per iteration. Fingerprints can collide, so a hit
+	// rebuilds the earlier state from the start and compares the real thing before trusting it (another mu steps).
+	template<typename State, typename StepFunc, typename HashFunc, typename EqualFunc = std::equal_to<State>>
+	bool FindWithFingerprints(State& inOutState, StepFunc step, HashFunc hash, Result& outResult, uint64_t maxIterations = ~0ULL, EqualFunc equal = EqualFunc())
+	{
+		std::unordered_multimap<uint64_t, uint64_t> firstSeen; // Fingerprint -> iteration
+		const State start = inOutState;
+		State& current = inOutState;
+		State earlier;
+		for (uint64_t iteration = 0; iteration <= maxIterations; ++iteration)
+		{
+			const uint64_t fingerprint = hash(current);
+			const auto candidates = firstSeen.equal_range(fingerprint);
+			for (auto itCandidate = candidates.first; itCandidate != candidates.second; ++itCandidate)
+			{
+				GetStateAt(start, step, Result(), itCandidate->second, earlier);
+				if (equal(earlier, current))
+				{
+					outResult.mu = itCandidate->second;
+					outResult.lambda = iteration - itCandidate->second;
+					return true;
+				}
+			}
+
+			firstSeen.emplace(fingerprint, iteration);
+			step(current);
+		}
+
+		return false;
+	}
+} // Cycle
@@ -5,11 +5,17 @@
 #include "AStar.h"
 #include "BDFS.h"
 #include "Bit.h"
+#include "Cycle.h"
 #include "Debug.h"
 #include "Enum.h"
 #include "FileStream.h"
 #include "Hash.h"
+#include "Int128.h"
+#include "Intercept.h"
 #include "IntVec.h"
 #include "Math.h"
+#include "MinCut.h"
+#include "Parallel.h"
+#include "Polygon.h"
 #include "StringUtil.h"
 #include "Vec.h"
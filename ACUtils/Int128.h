@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <intrin.h>
+#include <string>
+
+// Signed 128 bit integer (two's complement, wrapping), for the spots where a product of two int64s has to stay exact.
+// MSVC has no native 128 bit type, so this sits on top of the _mul128 / _umul128 intrinsics.
+struct Int128
+{
+public:
+	Int128() : lo(0), hi(0) {}
+	Int128(int64_t value) : lo((uint64_t)value), hi(value < 0 ? -1 : 0) {}
+	Int128(int64_t _hi, uint64_t _lo) : lo(_lo), hi(_hi) {}
+
+	// Full product of two int64s, can't overflow.
+	static Int128 Multiply(int64_t a, int64_t b)
+	{
+		int64_t high = 0;
+		const uint64_t low = (uint64_t)_mul128(a, b, &high);
+		return Int128(high, low);
+	}
+
+	Int128 operator+(const Int128& RHS) const
+	{
+		const uint64_t low = lo + RHS.lo;
+		const uint64_t carry = low < lo ? 1 : 0;
+		return Int128((int64_t)((uint64_t)hi + (uint64_t)RHS.hi + carry), low);
+	}
+
+	Int128 operator-(const Int128& RHS) const { return *this + (-RHS); }
+
+	Int128 operator-() const
+	{
+		const uint64_t low = ~lo + 1;
+		return Int128((int64_t)(~(uint64_t)hi + (low == 0 ? 1 : 0)), low);
+	}
+
+	// Low 128 bits of the product, exact as long as the result fits.
+	Int128 operator*(const Int128& RHS) const
+	{
+		uint64_t high = 0;
+		const uint64_t low = _umul128(lo, RHS.lo, &high);
+		high += lo * (uint64_t)RHS.hi + (uint64_t)hi * RHS.lo;
+		return Int128((int64_t)high, low);
+	}
+
+	// Arithmetic shift, so negative values round toward negative infinity.
+	Int128 operator>>(uint32_t shift) const
+	{
+		if (shift == 0)
+		{
+			return *this;
+		}
+
+		if (shift >= 64)
+		{
+			return Int128(hi >> 63, (uint64_t)(hi >> std::min(shift - 64, 63U)));
+		}
+
+		return Int128(hi >> shift, (lo >> shift) | ((uint64_t)hi << (64 - shift)));
+	}
+
+	Int128 operator<<(uint32_t shift) const
+	{
+		if (shift == 0)
+		{
+			return *this;
+		}
+
+		if (shift >= 64)
+		{
+			return Int128(shift >= 128 ? 0 : (int64_t)(lo << (shift - 64)), 0);
+		}
+
+		return Int128((int64_t)(((uint64_t)hi << shift) | (lo >> (64 - shift))), lo << shift);
+	}
+
+	Int128 Abs() const { return IsNegative() ? -(*this) : *this; }
+
+	Int128& operator+=(const Int128& RHS) { *this = *this + RHS; return *this; }
+	Int128& operator-=(const Int128& RHS) { *this = *this - RHS; return *this; }
+	Int128& operator*=(const Int128& RHS) { *this = *this * RHS; return *this; }
+
+	bool operator==(const Int128& RHS) const { return hi == RHS.hi && lo == RHS.lo; }
+	bool operator!=(const Int128& RHS) const { return hi != RHS.hi || lo != RHS.lo; }
+	bool operator<(const Int128& RHS) const { return hi != RHS.hi ? hi < RHS.hi : lo < RHS.lo; }
+	bool operator>(const Int128& RHS) const { return RHS < *this; }
+	bool operator<=(const Int128& RHS) const { return !(RHS < *this); }
+	bool operator>=(const Int128& RHS) const { return !(*this < RHS); }
+
+	bool IsNegative() const { return hi < 0; }
+	bool IsZero() const { return hi == 0 && lo == 0; }
+	int32_t Sign() const { return hi < 0 ? -1 : (IsZero() ? 0 : 1); } // Returns -1, 0, or 1
+
+	// True if the value survives a round trip through int64_t.
+	bool FitsInt64() const { return hi == ((int64_t)lo < 0 ? -1 : 0); }
+	int64_t ToInt64() const { return (int64_t)lo; }
+	double ToDouble() const { return (double)hi * 18446744073709551616.0 + (double)lo; }
+
+	// Base 10, with a leading '-' for negatives.
+	std::string ToString() const
+	{
+		// Long division of the magnitude by 10, 32 bits at a time, most significant limb first.
+		const Int128 magnitude = Abs();
+		uint32_t limbs[4] = { (uint32_t)((uint64_t)magnitude.hi >> 32), (uint32_t)magnitude.hi, (uint32_t)(magnitude.lo >> 32), (uint32_t)magnitude.lo };
+		std::string digits;
+		do
+		{
+			uint64_t remainder = 0;
+			for (uint32_t& limb : limbs)
+			{
+				const uint64_t value = (remainder << 32) | limb;
+				limb = (uint32_t)(value / 10);
+				remainder = value % 10;
+			}
+			digits.push_back((char)('0' + remainder));
+		} while (limbs[0] | limbs[1] | limbs[2] | limbs[3]);
+
+		if (IsNegative())
+		{
+			digits.push_back('-');
+		}
+		return std::string(digits.rbegin(), digits.rend());
+	}
+
+	uint64_t GetLow() const { return lo; }
+	int64_t GetHigh() const { return hi; }
+
+private:
+	uint64_t lo;
+	int64_t hi;
+};
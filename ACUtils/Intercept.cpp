@@ -0,0 +1,174 @@
+#include "Intercept.h"
+
+#include <assert.h>
+#include <utility>
+#include "Int128.h"
+#include "Math.h"
+
+namespace
+{
+	// Mersenne prime, anything within +/- 2^60 survives the trip through it untouched.
+	static constexpr uint64_t SOLVE_MODULUS = (1ULL << 61) - 1;
+	static constexpr uint32_t UNKNOWNS = 6;
+
+	uint64_t ToResidue(int64_t value)
+	{
+		const int64_t residue = value % (int64_t)SOLVE_MODULUS;
+		return (uint64_t)(residue < 0 ? residue + (int64_t)SOLVE_MODULUS : residue);
+	}
+
+	int64_t FromResidue(uint64_t residue)
+	{
+		return residue > SOLVE_MODULUS / 2 ? (int64_t)residue - (int64_t)SOLVE_MODULUS : (int64_t)residue;
+	}
+
+	uint64_t SubMod(uint64_t a, uint64_t b)
+	{
+		return a >= b ? a - b : a + SOLVE_MODULUS - b;
+	}
+
+	// (P - a) x (V - va) = (P - b) x (V - vb) expands to P x (vb - va) + (b - a) x V = b x vb - a x va, three rows per pair.
+	void AddPairRows(const Int64Vec3& a, const Int64Vec3& va, const Int64Vec3& b, const Int64Vec3& vb, uint64_t (*rows)[UNKNOWNS + 1])
+	{
+		const Int64Vec3 u = vb - va;
+		const Int64Vec3 w = b - a;
+
+		// Unknown order is Px, Py, Pz, Vx, Vy, Vz.
+		const int64_t coefficients[3][UNKNOWNS] =
+		{
+			{ 0, u.z, -u.y, 0, -w.z, w.y },
+			{ -u.z, 0, u.x, w.z, 0, -w.x },
+			{ u.y, -u.x, 0, -w.y, w.x, 0 },
+		};
+
+		for (uint32_t axis = 0; axis < 3; ++axis)
+		{
+			for (uint32_t column = 0; column < UNKNOWNS; ++column)
+			{
+				rows[axis][column] = ToResidue(coefficients[axis][column]);
+			}
+
+			// Component of b x vb - a x va, straight in modular space so the 10^17ish products can't overflow.
+			const uint32_t first = (axis + 1) % 3;
+			const uint32_t second = (axis + 2) % 3;
+			const uint64_t crossB = SubMod(Math::MulMod64(ToResidue(b[first]), ToResidue(vb[second]), SOLVE_MODULUS), Math::MulMod64(ToResidue(b[second]), ToResidue(vb[first]), SOLVE_MODULUS));
+			const uint64_t crossA = SubMod(Math::MulMod64(ToResidue(a[first]), ToResidue(va[second]), SOLVE_MODULUS), Math::MulMod64(ToResidue(a[second]), ToResidue(va[first]), SOLVE_MODULUS));
+			rows[axis][UNKNOWNS] = SubMod(crossB, crossA);
+		}
+	}
+
+	// Gauss-Jordan in place. False if the system is singular (mod our prime).
+	bool SolveModular(uint64_t (*system)[UNKNOWNS + 1], int64_t* outSolution)
+	{
+		for (uint32_t column = 0; column < UNKNOWNS; ++column)
+		{
+			uint32_t pivot = column;
+			while (pivot < UNKNOWNS && system[pivot][column] == 0)
+			{
+				++pivot;
+			}
+
+			if (pivot == UNKNOWNS)
+			{
+				return false;
+			}
+
+			std::swap(system[pivot], system[column]);
+
+			const uint64_t inverse = Math::PowMod64(system[column][column], SOLVE_MODULUS - 2, SOLVE_MODULUS);
+			for (uint32_t i = column; i <= UNKNOWNS; ++i)
+			{
+				system[column][i] = Math::MulMod64(system[column][i], inverse, SOLVE_MODULUS);
+			}
+
+			for (uint32_t row = 0; row < UNKNOWNS; ++row)
+			{
+				const uint64_t factor = system[row][column];
+				if (row == column || factor == 0)
+				{
+					continue;
+				}
+
+				for (uint32_t i = column; i <= UNKNOWNS; ++i)
+				{
+					system[row][i] = SubMod(system[row][i], Math::MulMod64(factor, system[column][i], SOLVE_MODULUS));
+				}
+			}
+		}
+
+		for (uint32_t i = 0; i < UNKNOWNS; ++i)
+		{
+			outSolution[i] = FromResidue(system[i][UNKNOWNS]);
+		}
+		return true;
+	}
+}
+
+bool Intercept::DoesThrowHit(const Int64Vec3& throwPosition, const Int64Vec3& throwVelocity, const Int64Vec3& position, const Int64Vec3& velocity)
+{
+	// Hit at t means position - throwPosition = t * (throwVelocity - velocity), so the two have to be parallel and point the same way.
+	const Int64Vec3 offset = position - throwPosition;
+	const Int64Vec3 closing = throwVelocity - velocity;
+
+	if (offset.IsZero())
+	{
+		return true;
+	}
+
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		const int first = (axis + 1) % 3;
+		const int second = (axis + 2) % 3;
+		if (Int128::Multiply(offset[first], closing[second]) != Int128::Multiply(offset[second], closing[first]))
+		{
+			return false;
+		}
+	}
+
+	const Int128 dot = Int128::Multiply(offset.x, closing.x) + Int128::Multiply(offset.y, closing.y) + Int128::Multiply(offset.z, closing.z);
+	return dot.Sign() > 0;
+}
+
+bool Intercept::FindThrowThroughAll(const std::vector<Int64Vec3>& positions, const std::vector<Int64Vec3>& velocities, Int64Vec3& outPosition, Int64Vec3& outVelocity)
+{
+	assert(positions.size() == velocities.size());
+	const uint32_t count = (uint32_t)positions.size();
+	if (count < 3)
+	{
+		return false;
+	}
+
+	// Any three projectiles in general position pin the answer down. Walk triples until one gives a full rank system.
+	uint64_t system[UNKNOWNS][UNKNOWNS + 1];
+	int64_t solution[UNKNOWNS];
+	for (uint32_t second = 1; second < count; ++second)
+	{
+		for (uint32_t third = second + 1; third < count; ++third)
+		{
+			AddPairRows(positions[0], velocities[0], positions[second], velocities[second], &system[0]);
+			AddPairRows(positions[0], velocities[0], positions[third], velocities[third], &system[3]);
+
+			if (!SolveModular(system, solution))
+			{
+				continue;
+			}
+
+			// A full rank system has one answer, so if it doesn't check out against everybody there's no integer throw at all.
+			const Int64Vec3 candidatePosition(solution[0], solution[1], solution[2]);
+			const Int64Vec3 candidateVelocity(solution[3], solution[4], solution[5]);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				if (!DoesThrowHit(candidatePosition, candidateVelocity, positions[i], velocities[i]))
+				{
+					return false;
+				}
+			}
+
+			outPosition = candidatePosition;
+			outVelocity = candidateVelocity;
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <vector>
+#include "IntVec.h"
+
+namespace Intercept
+{
+	// Finds the integer ray (outPosition + outVelocity * t) that hits every projectile (positions[i] + velocities[i] * t) at some t > 0.
+	// Time drops out by crossing (P - p_i) x (V - v_i) = 0 between pairs, which leaves a 6x6 linear system in P and V. That gets
+	// solved exactly (mod a 61 bit prime, answers are small enough to lift straight back) and checked against every projectile.
+	// Returns false if no such integer ray exists.
+	bool FindThrowThroughAll(const std::vector<Int64Vec3>& positions, const std::vector<Int64Vec3>& velocities, Int64Vec3& outPosition, Int64Vec3& outVelocity);
+
+	// True if the ray hits the projectile at some t > 0 (or they start out in the same place). Exact for |values| < 2^61: differences
+	// stay under 2^62, their products under 2^124, and the three term dot product under 2^127.
+	bool DoesThrowHit(const Int64Vec3& throwPosition, const Int64Vec3& throwVelocity, const Int64Vec3& position, const Int64Vec3& velocity);
+}
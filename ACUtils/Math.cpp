@@ -1,6 +1,10 @@
 #include "Math.h"
 
+#include "Int128.h"
 #include "IntVec.h"
+#include <assert.h>
+#include <cmath>
+#include <smmintrin.h>
 
 void Math::SinCos(float& outSine, float& outCosine, float value)
 {
@@ -63,6 +67,325 @@ uint64_t Math::GCD(uint64_t a, uint64_t b)
 	return GCD(b, a % b);
 }
 
+uint64_t Math::MulMod64(uint64_t a, uint64_t b, uint64_t mod)
+{
+	uint64_t high = 0;
+	const uint64_t low = _umul128(a % mod, b % mod, &high);
+
+	uint64_t remainder = 0;
+	_udiv128(high, low, mod, &remainder);
+	return remainder;
+}
+
+uint64_t Math::PowMod64(uint64_t base, uint64_t exp, uint64_t mod)
+{
+	uint64_t result = 1 % mod;
+	base %= mod;
+	while (exp)
+	{
+		if (exp & 1)
+		{
+			result = MulMod64(result, base, mod);
+		}
+		base = MulMod64(base, base, mod);
+		exp >>= 1;
+	}
+	return result;
+}
+
+bool Math::ModInverse64(uint64_t value, uint64_t mod, uint64_t& outInverse)
+{
+	// Extended Euclid, tracking only the coefficient for value. Coefficients stay within +/- mod so they're kept as magnitude + sign.
+	uint64_t oldR = value % mod;
+	uint64_t r = mod;
+	uint64_t oldS = 1;
+	uint64_t s = 0;
+	bool oldSNegative = false;
+	bool sNegative = false;
+	while (r != 0)
+	{
+		const uint64_t quotient = oldR / r;
+
+		const uint64_t nextR = oldR - quotient * r;
+		oldR = r;
+		r = nextR;
+
+		// nextS = oldS - quotient * s, with signs.
+		const uint64_t scaled = quotient * s;
+		uint64_t nextS = 0;
+		bool nextSNegative = false;
+		if (oldSNegative != sNegative)
+		{
+			nextS = oldS + scaled;
+			nextSNegative = oldSNegative;
+		}
+		else if (oldS >= scaled)
+		{
+			nextS = oldS - scaled;
+			nextSNegative = oldSNegative;
+		}
+		else
+		{
+			nextS = scaled - oldS;
+			nextSNegative = !oldSNegative;
+		}
+
+		oldS = s;
+		oldSNegative = sNegative;
+		s = nextS;
+		sNegative = nextSNegative;
+	}
+
+	if (oldR != 1)
+	{
+		return false;
+	}
+
+	oldS %= mod;
+	outInverse = (oldSNegative && oldS != 0) ? mod - oldS : oldS;
+	return true;
+}
+
+bool Math::CombineCongruences(uint64_t a1, uint64_t m1, uint64_t a2, uint64_t m2, uint64_t& outA, uint64_t& outM)
+{
+	a1 %= m1;
+	a2 %= m2;
+
+	const uint64_t g = GCD(m1, m2);
+	if (a1 % g != a2 % g)
+	{
+		return false;
+	}
+
+	uint64_t lcmHigh = 0;
+	const uint64_t lcm = _umul128(m1 / g, m2, &lcmHigh);
+	if (lcmHigh != 0)
+	{
+		return false;
+	}
+
+	// x = a1 + m1 * k, with (m1 / g) * k = (a2 - a1) / g (mod m2 / g).
+	const uint64_t reducedMod = m2 / g;
+	uint64_t inverse = 0;
+	if (reducedMod == 1)
+	{
+		outA = a1;
+		outM = lcm;
+		return true;
+	}
+
+	const bool hasInverse = ModInverse64((m1 / g) % reducedMod, reducedMod, inverse);
+	assert(hasInverse);
+	(void)hasInverse;
+
+	const uint64_t difference = (a2 >= a1 % m2 ? a2 - a1 % m2 : a2 + m2 - a1 % m2) / g;
+	const uint64_t k = MulMod64(difference, inverse, reducedMod);
+	outA = a1 + m1 * k; // < lcm, so no overflow.
+	outM = lcm;
+	return true;
+}
+
+uint64_t Math::ISqrt64(uint64_t value)
+{
+	// The double gets within a couple of the answer, then nudge it onto the exact floor.
+	uint64_t root = std::min((uint64_t)std::sqrt((double)value), (uint64_t)0xFFFFFFFF);
+	while (root * root > value)
+	{
+		--root;
+	}
+
+	while (root < 0xFFFFFFFF && (root + 1) * (root + 1) <= value)
+	{
+		++root;
+	}
+
+	return root;
+}
+
+uint64_t Math::ISqrt128(uint64_t high, uint64_t low)
+{
+	if (high == 0)
+	{
+		return ISqrt64(low);
+	}
+	assert(high < (1ULL << 62));
+
+	// True if root * root <= high:low
+	auto squareFits = [high, low](uint64_t root)
+	{
+		uint64_t squareHigh = 0;
+		const uint64_t squareLow = _umul128(root, root, &squareHigh);
+		return squareHigh < high || (squareHigh == high && squareLow <= low);
+	};
+
+	// The double is only good to ~53 bits, one Newton step brings it back to within one.
+	uint64_t root = (uint64_t)std::sqrt((double)high * 18446744073709551616.0 + (double)low);
+	uint64_t remainder = 0;
+	root = (root + _udiv128(high, low, root, &remainder)) / 2;
+
+	while (!squareFits(root))
+	{
+		--root;
+	}
+
+	while (squareFits(root + 1))
+	{
+		++root;
+	}
+
+	return root;
+}
+
+uint64_t Math::CountProductsAbove(uint64_t sum, uint64_t threshold)
+{
+	assert(sum < (1ULL << 63));
+
+	// i * (T - i) > D  <=>  (T - 2i)^2 < T^2 - 4D, so the winners sit within sqrt(T^2 - 4D) / 2 of T / 2.
+	uint64_t squareHigh = 0;
+	const uint64_t squareLow = _umul128(sum, sum, &squareHigh);
+	const uint64_t fourDHigh = threshold >> 62;
+	const uint64_t fourDLow = threshold << 2;
+	if (squareHigh < fourDHigh || (squareHigh == fourDHigh && squareLow <= fourDLow))
+	{
+		return 0;
+	}
+
+	const uint64_t discriminantLow = squareLow - fourDLow;
+	const uint64_t discriminantHigh = squareHigh - fourDHigh - (squareLow < fourDLow ? 1 : 0);
+	const uint64_t root = ISqrt128(discriminantHigh, discriminantLow);
+
+	auto isAbove = [sum, threshold](uint64_t i)
+	{
+		uint64_t productHigh = 0;
+		const uint64_t productLow = _umul128(i, sum - i, &productHigh);
+		return productHigh != 0 || productLow > threshold;
+	};
+
+	// The floored root puts this within one of the first winner, so fix it up against the real inequality.
+	uint64_t first = (sum - root) / 2;
+	while (first > 0 && isAbove(first - 1))
+	{
+		--first;
+	}
+
+	while (first <= sum / 2 && !isAbove(first))
+	{
+		++first;
+	}
+
+	// Symmetric around T / 2, winners are [first, T - first].
+	return first <= sum / 2 ? sum - 2 * first + 1 : 0;
+}
+
+void Math::GetExtrapolationWeights(uint32_t count, std::vector<int64_t>& outWeights)
+{
+	assert(count <= MAX_EXTRAPOLATION_SAMPLES);
+
+	// weights[i] = (-1)^(count - 1 - i) * C(count, i)
+	outWeights.resize(count);
+	uint64_t binomial = 1; // Unsigned so the multiply before the divide doesn't overflow at 62.
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		outWeights[i] = ((count - 1 - i) & 1) ? -(int64_t)binomial : (int64_t)binomial;
+		binomial = binomial * (count - i) / (i + 1);
+	}
+}
+
+bool Math::ExtrapolateChecked(const int64_t* values, uint32_t count, const std::vector<int64_t>& weights, int64_t& outNext, int64_t& outPrevious)
+{
+	assert(weights.size() == count);
+
+	Int128 next;
+	Int128 previous;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		next += Int128::Multiply(weights[i], values[i]);
+		previous += Int128::Multiply(weights[count - 1 - i], values[i]);
+	}
+
+	outNext = next.ToInt64();
+	outPrevious = previous.ToInt64();
+	return next.FitsInt64() && previous.FitsInt64();
+}
+
+bool Math::ExtrapolateBatch(const int32_t* values, uint32_t count, size_t sequenceCount, const std::vector<int64_t>& weights, int64_t* outNext, int64_t* outPrevious)
+{
+	assert(weights.size() == count);
+
+	// Weights have to fit the 32 bit multiplies, and no partial sum can leave int64: |sum| <= max|value| * sum|weights|,
+	// where the weights' magnitudes add up to 2^count - 1.
+	if (count > MAX_BATCH_EXTRAPOLATION_SAMPLES)
+	{
+		return false;
+	}
+
+	uint64_t maxMagnitude = 0;
+	for (size_t i = 0; i < (size_t)count * sequenceCount; ++i)
+	{
+		maxMagnitude = std::max(maxMagnitude, (uint64_t)std::llabs(values[i]));
+	}
+
+	uint64_t boundHigh = 0;
+	const uint64_t boundLow = _umul128(maxMagnitude, (1ULL << count) - 1, &boundHigh);
+	if (boundHigh != 0 || boundLow > (uint64_t)INT64_MAX)
+	{
+		return false;
+	}
+
+	// Four sequences per step. _mm_mul_epi32 only multiplies the even 32 bit lanes, so the odd ones get shifted down into
+	// a second set of accumulators.
+	size_t sequence = 0;
+	for (; sequence + 4 <= sequenceCount; sequence += 4)
+	{
+		__m128i nextEven = _mm_setzero_si128();
+		__m128i nextOdd = _mm_setzero_si128();
+		__m128i previousEven = _mm_setzero_si128();
+		__m128i previousOdd = _mm_setzero_si128();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const __m128i samples = _mm_loadu_si128((const __m128i*)(values + (size_t)i * sequenceCount + sequence));
+			const __m128i oddSamples = _mm_srli_epi64(samples, 32);
+			const __m128i nextWeight = _mm_set1_epi32((int32_t)weights[i]);
+			const __m128i previousWeight = _mm_set1_epi32((int32_t)weights[count - 1 - i]);
+
+			nextEven = _mm_add_epi64(nextEven, _mm_mul_epi32(samples, nextWeight));
+			nextOdd = _mm_add_epi64(nextOdd, _mm_mul_epi32(oddSamples, nextWeight));
+			previousEven = _mm_add_epi64(previousEven, _mm_mul_epi32(samples, previousWeight));
+			previousOdd = _mm_add_epi64(previousOdd, _mm_mul_epi32(oddSamples, previousWeight));
+		}
+
+		int64_t lanes[2];
+		_mm_storeu_si128((__m128i*)lanes, nextEven);
+		outNext[sequence] = lanes[0];
+		outNext[sequence + 2] = lanes[1];
+		_mm_storeu_si128((__m128i*)lanes, nextOdd);
+		outNext[sequence + 1] = lanes[0];
+		outNext[sequence + 3] = lanes[1];
+		_mm_storeu_si128((__m128i*)lanes, previousEven);
+		outPrevious[sequence] = lanes[0];
+		outPrevious[sequence + 2] = lanes[1];
+		_mm_storeu_si128((__m128i*)lanes, previousOdd);
+		outPrevious[sequence + 1] = lanes[0];
+		outPrevious[sequence + 3] = lanes[1];
+	}
+
+	for (; sequence < sequenceCount; ++sequence)
+	{
+		int64_t next = 0;
+		int64_t previous = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const int64_t sample = values[(size_t)i * sequenceCount + sequence];
+			next += weights[i] * sample;
+			previous += weights[count - 1 - i] * sample;
+		}
+		outNext[sequence] = next;
+		outPrevious[sequence] = previous;
+	}
+
+	return true;
+}
+
 int32_t Math::EstimatePrimeNumbersInRange(int32_t UpperLimit)
 {
 	return UpperLimit / (int32_t)ceilf(logf((float)UpperLimit));
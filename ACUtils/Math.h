@@ -61,6 +61,33 @@ namespace Math
 	uint64_t LCM(uint64_t a, uint64_t b);
 	uint64_t GCD(uint64_t a, uint64_t b);
 
+	// Modular arithmetic, products go through 128 bits so any 64 bit modulus works.
+	uint64_t MulMod64(uint64_t a, uint64_t b, uint64_t mod);
+	uint64_t PowMod64(uint64_t base, uint64_t exp, uint64_t mod);
+	bool ModInverse64(uint64_t value, uint64_t mod, uint64_t& outInverse); // False if value and mod aren't coprime.
+
+	// Generalized CRT, moduli don't need to be coprime. Merges x = a1 (mod m1) and x = a2 (mod m2) into x = outA (mod outM).
+	// False if the two disagree, or the combined modulus doesn't fit in 64 bits.
+	bool CombineCongruences(uint64_t a1, uint64_t m1, uint64_t a2, uint64_t m2, uint64_t& outA, uint64_t& outM);
+
+	// Exact floor(sqrt(value)), no floating point error. The 128 bit version takes high:low up to 2^126.
+	uint64_t ISqrt64(uint64_t value);
+	uint64_t ISqrt128(uint64_t high, uint64_t low);
+
+	// How many integers i in [0, sum] have i * (sum - i) > threshold. Closed form, exact for sum < 2^63.
+	uint64_t CountProductsAbove(uint64_t sum, uint64_t threshold);
+
+	// Newton forward differences. count samples of a polynomial with degree < count continue as
+	// next = sum(weights[i] * values[i]), and going backwards it's the same with the weights reversed.
+	static constexpr uint32_t MAX_EXTRAPOLATION_SAMPLES = 62; // Binomials still fit an int64.
+	static constexpr uint32_t MAX_BATCH_EXTRAPOLATION_SAMPLES = 32; // Binomials still fit an int32.
+	void GetExtrapolationWeights(uint32_t count, std::vector<int64_t>& outWeights);
+	bool ExtrapolateChecked(const int64_t* values, uint32_t count, const std::vector<int64_t>& weights, int64_t& outNext, int64_t& outPrevious); // 128 bit sums, false on int64 overflow.
+
+	// Many sequences of the same length at once, four at a time in SSE. Column major, values[i * sequenceCount + sequence].
+	// False (and nothing written) if the 64 bit sums could overflow, use ExtrapolateChecked for those.
+	bool ExtrapolateBatch(const int32_t* values, uint32_t count, size_t sequenceCount, const std::vector<int64_t>& weights, int64_t* outNext, int64_t* outPrevious);
+
 	int32_t EstimatePrimeNumbersInRange(int32_t UpperLimit);
 	void PrimeFactorization32(uint32_t value, std::vector<uint32_t>& outFactors);
 	bool IsPrime(uint32_t WholeNumber);
@@ -0,0 +1,423 @@
+#include "MinCut.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <atomic>
+#include <queue>
+#include <random>
+#include "Parallel.h"
+
+void MinCut::Graph::AddEdge(uint32_t a, uint32_t b, uint32_t weight)
+{
+	assert(a < m_vertexCount && b < m_vertexCount);
+	if (a != b && weight != 0)
+	{
+		m_pendingEdges.push_back({ a, b, weight });
+	}
+}
+
+void MinCut::Graph::Build()
+{
+	m_arcOffsets.assign(m_vertexCount + 1, 0);
+	for (const PendingEdge& edge : m_pendingEdges)
+	{
+		++m_arcOffsets[edge.a + 1];
+		++m_arcOffsets[edge.b + 1];
+	}
+
+	for (uint32_t i = 0; i < m_vertexCount; ++i)
+	{
+		m_arcOffsets[i + 1] += m_arcOffsets[i];
+	}
+
+	const uint32_t arcCount = m_arcOffsets[m_vertexCount];
+	m_arcTargets.resize(arcCount);
+	m_arcWeights.resize(arcCount);
+	m_reverseArcs.resize(arcCount);
+
+	std::vector<uint32_t> cursor(m_arcOffsets.begin(), m_arcOffsets.end() - 1);
+	for (const PendingEdge& edge : m_pendingEdges)
+	{
+		const uint32_t forward = cursor[edge.a]++;
+		const uint32_t backward = cursor[edge.b]++;
+		m_arcTargets[forward] = edge.b;
+		m_arcWeights[forward] = edge.weight;
+		m_reverseArcs[forward] = backward;
+		m_arcTargets[backward] = edge.a;
+		m_arcWeights[backward] = edge.weight;
+		m_reverseArcs[backward] = forward;
+	}
+
+	m_pendingEdges.clear();
+}
+
+namespace
+{
+	class DisjointSet
+	{
+	public:
+		void Reset(uint32_t count)
+		{
+			m_parent.resize(count);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				m_parent[i] = i;
+			}
+		}
+
+		uint32_t Find(uint32_t value)
+		{
+			uint32_t root = value;
+			while (m_parent[root] != root)
+			{
+				root = m_parent[root];
+			}
+
+			while (m_parent[value] != root)
+			{
+				const uint32_t next = m_parent[value];
+				m_parent[value] = root;
+				value = next;
+			}
+			return root;
+		}
+
+		// False if they were already joined.
+		bool Union(uint32_t a, uint32_t b)
+		{
+			a = Find(a);
+			b = Find(b);
+			if (a == b)
+			{
+				return false;
+			}
+			m_parent[b] = a;
+			return true;
+		}
+
+	private:
+		std::vector<uint32_t> m_parent;
+	};
+
+	void FillSideSizes(MinCut::Result& outResult)
+	{
+		outResult.sideASize = (uint32_t)std::count(outResult.onSideA.begin(), outResult.onSideA.end(), (uint8_t)1);
+		outResult.sideBSize = (uint32_t)outResult.onSideA.size() - outResult.sideASize;
+	}
+}
+
+bool MinCut::StoerWagner(const Graph& graph, Result& outResult)
+{
+	const uint32_t vertexCount = graph.GetVertexCount();
+	if (vertexCount < 2)
+	{
+		return false;
+	}
+
+	// Merged vertices are tracked as groups. Every original vertex points at its group, and each group knows its members, so a
+	// phase just walks the original CSR arcs and folds weights onto whichever group the target currently belongs to.
+	std::vector<uint32_t> groupOf(vertexCount);
+	std::vector<std::vector<uint32_t>> members(vertexCount);
+	std::vector<uint32_t> activeGroups(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		groupOf[i] = i;
+		members[i].push_back(i);
+		activeGroups[i] = i;
+	}
+
+	std::vector<uint64_t> connection(vertexCount, 0);
+	std::vector<uint8_t> added(vertexCount, 0);
+	typedef std::pair<uint64_t, uint32_t> HeapEntry;
+
+	uint64_t bestCut = ~0ULL;
+	std::vector<uint32_t> bestSide;
+
+	while (activeGroups.size() > 1)
+	{
+		// Maximum adjacency ordering: keep adding whichever group is most tightly connected to everything added so far.
+		for (uint32_t group : activeGroups)
+		{
+			connection[group] = 0;
+			added[group] = 0;
+		}
+
+		std::priority_queue<HeapEntry> heap;
+		heap.push(HeapEntry(0, activeGroups[0]));
+
+		uint32_t previous = activeGroups[0];
+		uint32_t last = activeGroups[0];
+		uint32_t addedCount = 0;
+		while (addedCount < activeGroups.size())
+		{
+			const HeapEntry top = heap.top();
+			heap.pop();
+			if (added[top.second] || top.first != connection[top.second])
+			{
+				continue; // Stale.
+			}
+
+			previous = last;
+			last = top.second;
+			added[last] = 1;
+			++addedCount;
+
+			for (uint32_t member : members[last])
+			{
+				for (uint32_t arc = graph.GetArcBegin(member); arc < graph.GetArcEnd(member); ++arc)
+				{
+					const uint32_t targetGroup = groupOf[graph.GetArcTarget(arc)];
+					if (!added[targetGroup])
+					{
+						connection[targetGroup] += graph.GetArcWeight(arc);
+						heap.push(HeapEntry(connection[targetGroup], targetGroup));
+					}
+				}
+			}
+
+			// Disconnected leftovers never make it into the heap, pull the next one in at zero.
+			if (heap.empty() && addedCount < activeGroups.size())
+			{
+				for (uint32_t group : activeGroups)
+				{
+					if (!added[group])
+					{
+						heap.push(HeapEntry(0, group));
+						break;
+					}
+				}
+			}
+		}
+
+		// Cut of the phase separates the last group added from everything else.
+		if (connection[last] < bestCut)
+		{
+			bestCut = connection[last];
+			bestSide = members[last];
+		}
+
+		// Merge the last two.
+		for (uint32_t member : members[last])
+		{
+			groupOf[member] = previous;
+		}
+		members[previous].insert(members[previous].end(), members[last].begin(), members[last].end());
+		members[last].clear();
+		activeGroups.erase(std::find(activeGroups.begin(), activeGroups.end(), last));
+	}
+
+	outResult.cutWeight = bestCut;
+	outResult.onSideA.assign(vertexCount, 0);
+	for (uint32_t vertex : bestSide)
+	{
+		outResult.onSideA[vertex] = 1;
+	}
+	FillSideSizes(outResult);
+	return true;
+}
+
+bool MinCut::FindCutOfSize(const Graph& graph, uint32_t cutSize, Result& outResult)
+{
+	const uint32_t vertexCount = graph.GetVertexCount();
+	if (vertexCount < 2)
+	{
+		return false;
+	}
+
+	const uint32_t source = 0;
+	std::vector<uint32_t> residual(graph.GetArcCount());
+	std::vector<uint32_t> parentArc(vertexCount);
+	std::vector<uint8_t> reached(vertexCount);
+	std::vector<uint32_t> queue;
+	queue.reserve(vertexCount);
+
+	// BFS over arcs with capacity left. Fills reached / parentArc, returns true if the sink was hit.
+	auto findPath = [&](uint32_t sink)
+	{
+		std::fill(reached.begin(), reached.end(), (uint8_t)0);
+		queue.clear();
+		queue.push_back(source);
+		reached[source] = 1;
+		for (size_t head = 0; head < queue.size(); ++head)
+		{
+			const uint32_t vertex = queue[head];
+			for (uint32_t arc = graph.GetArcBegin(vertex); arc < graph.GetArcEnd(vertex); ++arc)
+			{
+				const uint32_t target = graph.GetArcTarget(arc);
+				if (reached[target] || residual[arc] == 0)
+				{
+					continue;
+				}
+
+				reached[target] = 1;
+				parentArc[target] = arc;
+				if (target == sink)
+				{
+					return true;
+				}
+				queue.push_back(target);
+			}
+		}
+		return false;
+	};
+
+	for (uint32_t sink = 1; sink < vertexCount; ++sink)
+	{
+		for (uint32_t arc = 0; arc < graph.GetArcCount(); ++arc)
+		{
+			residual[arc] = graph.GetArcWeight(arc);
+		}
+
+		// Only need to know whether more than cutSize fits, so stop pushing after cutSize + 1.
+		uint64_t flow = 0;
+		bool saturated = false;
+		while (flow <= cutSize)
+		{
+			if (!findPath(sink))
+			{
+				saturated = true;
+				break;
+			}
+
+			uint32_t bottleneck = ~0U;
+			for (uint32_t vertex = sink; vertex != source; vertex = graph.GetArcTarget(graph.GetReverseArc(parentArc[vertex])))
+			{
+				bottleneck = std::min(bottleneck, residual[parentArc[vertex]]);
+			}
+
+			for (uint32_t vertex = sink; vertex != source; vertex = graph.GetArcTarget(graph.GetReverseArc(parentArc[vertex])))
+			{
+				residual[parentArc[vertex]] -= bottleneck;
+				residual[graph.GetReverseArc(parentArc[vertex])] += bottleneck;
+			}
+			flow += bottleneck;
+		}
+
+		if (saturated && flow <= cutSize)
+		{
+			// Whatever the source can still reach is its side of the cut.
+			outResult.cutWeight = flow;
+			outResult.onSideA.assign(reached.begin(), reached.end());
+			FillSideSizes(outResult);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool MinCut::Karger(const Graph& graph, uint32_t maxTrials, uint64_t targetCutWeight, uint64_t seed, Result& outResult)
+{
+	const uint32_t vertexCount = graph.GetVertexCount();
+	if (vertexCount < 2 || maxTrials == 0)
+	{
+		return false;
+	}
+
+	// One entry per undirected edge, the arc going from the lower vertex.
+	std::vector<uint32_t> edgeArcs;
+	for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+	{
+		for (uint32_t arc = graph.GetArcBegin(vertex); arc < graph.GetArcEnd(vertex); ++arc)
+		{
+			if (arc < graph.GetReverseArc(arc))
+			{
+				edgeArcs.push_back(arc);
+			}
+		}
+	}
+
+	// Every trial seeds its own generator from (seed, trial) and shuffles from the same starting order, so it plays out the same
+	// no matter which worker picks it up. Ties go to the lowest trial, and any cut at or under the target counts as a tie, so
+	// once one is found only later trials get skipped and the result doesn't depend on thread timing.
+	struct WorkerState
+	{
+		std::vector<uint32_t> order;
+		DisjointSet components;
+		uint64_t bestKey = ~0ULL;
+		uint64_t bestCut = ~0ULL;
+		size_t bestTrial = ~(size_t)0;
+		std::vector<uint8_t> bestSide;
+	};
+
+	const uint32_t workerCount = Parallel::GetWorkerCount(maxTrials);
+	std::vector<WorkerState> workers(workerCount);
+
+	std::atomic<size_t> firstTargetTrial(~(size_t)0);
+	Parallel::ForEach(maxTrials, [&](uint32_t workerIndex, size_t trial)
+	{
+		if (trial > firstTargetTrial.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		WorkerState& worker = workers[workerIndex];
+		std::seed_seq seedSequence = { (uint32_t)seed, (uint32_t)(seed >> 32), (uint32_t)trial, (uint32_t)((uint64_t)trial >> 32) };
+		std::mt19937_64 rng(seedSequence);
+		worker.order = edgeArcs;
+		std::shuffle(worker.order.begin(), worker.order.end(), rng);
+		worker.components.Reset(vertexCount);
+
+		uint32_t remaining = vertexCount;
+		for (size_t i = 0; i < worker.order.size() && remaining > 2; ++i)
+		{
+			const uint32_t arc = worker.order[i];
+			if (worker.components.Union(graph.GetArcTarget(graph.GetReverseArc(arc)), graph.GetArcTarget(arc)))
+			{
+				--remaining;
+			}
+		}
+
+		// Whatever still spans the two components is the cut. If the graph was disconnected there may be more than two left,
+		// vertex 0's component against the rest is a zero cut then.
+		uint64_t cutWeight = 0;
+		for (uint32_t arc : worker.order)
+		{
+			if (worker.components.Find(graph.GetArcTarget(graph.GetReverseArc(arc))) != worker.components.Find(graph.GetArcTarget(arc)))
+			{
+				cutWeight += graph.GetArcWeight(arc);
+			}
+		}
+
+		const uint64_t key = cutWeight <= targetCutWeight ? 0 : cutWeight;
+		if (key < worker.bestKey || (key == worker.bestKey && trial < worker.bestTrial))
+		{
+			const uint32_t sideA = worker.components.Find(0);
+			worker.bestKey = key;
+			worker.bestCut = cutWeight;
+			worker.bestTrial = trial;
+			worker.bestSide.resize(vertexCount);
+			for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+			{
+				worker.bestSide[vertex] = worker.components.Find(vertex) == sideA ? 1 : 0;
+			}
+		}
+
+		if (key == 0)
+		{
+			size_t current = firstTargetTrial.load(std::memory_order_relaxed);
+			while (trial < current && !firstTargetTrial.compare_exchange_weak(current, trial, std::memory_order_relaxed))
+			{
+			}
+		}
+	});
+
+	const WorkerState* best = nullptr;
+	for (const WorkerState& worker : workers)
+	{
+		if (!worker.bestSide.empty() && (best == nullptr || worker.bestKey < best->bestKey || (worker.bestKey == best->bestKey && worker.bestTrial < best->bestTrial)))
+		{
+			best = &worker;
+		}
+	}
+
+	if (best == nullptr)
+	{
+		return false;
+	}
+
+	outResult.cutWeight = best->bestCut;
+	outResult.onSideA = best->bestSide;
+	FillSideSizes(outResult);
+	return best->bestCut <= targetCutWeight;
+}
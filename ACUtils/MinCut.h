@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/*
+	Minimum cuts on undirected graphs.
+
+	Graph - Dense vertex ids in [0, vertexCount), edges get compacted into CSR form by Build. Parallel edges are fine, they just add up.
+	Result - Weight of the cut, how many vertices land on each side, and which side each vertex is on.
+
+	StoerWagner - Deterministic global min cut, O(V * E log E). A lazy heap (stale entries get skipped, not decreased) drives the maximum adjacency ordering.
+	FindCutOfSize - For when the cut is known to be small (k). Pushes unit flow from vertex 0 with Edmonds-Karp until k + 1 paths
+					can't be found to some sink, then the residual graph gives the cut. O(k * E) per sink tried, and for a cut that splits
+					the graph roughly evenly only a couple of sinks ever get tried.
+	Karger - Randomized contraction. Each trial shuffles the edge list once and unions endpoints (path compressed union-find) in that
+			 order until two components remain. Trials run on every core, each with an RNG seeded from seed and its trial index, so a
+			 given seed always gives the same cut. They stop once one finds a cut of targetCutWeight or less. Edges are picked uniformly regardless of weight, so it's meant for unit weight graphs.
+*/
+namespace MinCut
+{
+	class Graph
+	{
+	public:
+		Graph(uint32_t vertexCount) : m_vertexCount(vertexCount) {}
+
+		void AddEdge(uint32_t a, uint32_t b, uint32_t weight = 1);
+
+		// Compacts pending edges into CSR arrays, must be called before handing the graph to a solver.
+		void Build();
+
+		uint32_t GetVertexCount() const { return m_vertexCount; }
+		uint32_t GetArcBegin(uint32_t vertex) const { return m_arcOffsets[vertex]; }
+		uint32_t GetArcEnd(uint32_t vertex) const { return m_arcOffsets[vertex + 1]; }
+		uint32_t GetArcTarget(uint32_t arc) const { return m_arcTargets[arc]; }
+		uint32_t GetArcWeight(uint32_t arc) const { return m_arcWeights[arc]; }
+		uint32_t GetReverseArc(uint32_t arc) const { return m_reverseArcs[arc]; }
+		uint32_t GetArcCount() const { return (uint32_t)m_arcTargets.size(); }
+
+	private:
+		struct PendingEdge
+		{
+			uint32_t a;
+			uint32_t b;
+			uint32_t weight;
+		};
+
+		uint32_t m_vertexCount;
+		std::vector<PendingEdge> m_pendingEdges;
+		std::vector<uint32_t> m_arcOffsets;
+		std::vector<uint32_t> m_arcTargets;
+		std::vector<uint32_t> m_arcWeights;
+		std::vector<uint32_t> m_reverseArcs; // Same edge going the other way, for residual flow.
+	};
+
+	struct Result
+	{
+		uint64_t cutWeight = 0;
+		uint32_t sideASize = 0;
+		uint32_t sideBSize = 0;
+		std::vector<uint8_t> onSideA; // 1 if the vertex is on side A.
+	};
+
+	bool StoerWagner(const Graph& graph, Result& outResult);
+	bool FindCutOfSize(const Graph& graph, uint32_t cutSize, Result& outResult);
+	bool Karger(const Graph& graph, uint32_t maxTrials, uint64_t targetCutWeight, uint64_t seed, Result& outResult); // True if a cut <= targetCutWeight was found, outResult holds the best cut seen either way.
+}
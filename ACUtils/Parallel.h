@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace Parallel
+{
+	// Number of workers we'll spin up for a given amount of work. Never more workers than work items, never less than 1.
+	inline uint32_t GetWorkerCount(size_t workItems = ~(size_t)0)
+	{
+		const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1U);
+		return (uint32_t)std::max(std::min((size_t)hardwareThreads, workItems), (size_t)1);
+	}
+
+	// Runs func(workerIndex, itemIndex) for every item in [0, count). Items are handed out dynamically so uneven workloads still balance.
+	// workerIndex is in [0, GetWorkerCount(count)) and is stable for the lifetime of a worker, so callers can keep per-worker scratch memory / accumulators.
+	template<typename Func>
+	void ForEach(size_t count, Func func)
+	{
+		const uint32_t workerCount = GetWorkerCount(count);
+		if (workerCount == 1)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				func(0U, i);
+			}
+			return;
+		}
+
+		std::atomic<size_t> nextItem(0);
+		auto workerLoop = [&](uint32_t workerIndex)
+		{
+			for (size_t i = nextItem.fetch_add(1, std::memory_order_relaxed); i < count; i = nextItem.fetch_add(1, std::memory_order_relaxed))
+			{
+				func(workerIndex, i);
+			}
+		};
+
+		std::vector<std::thread> workers;
+		workers.reserve(workerCount - 1);
+		for (uint32_t i = 1; i < workerCount; ++i)
+		{
+			workers.emplace_back(workerLoop, i);
+		}
+
+		// Main thread does its share too.
+		workerLoop(0);
+
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+	}
+} // Parallel
@@ -0,0 +1,164 @@
+#include "Polygon.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <smmintrin.h>
+#include "Math.h"
+
+namespace
+{
+	// Lattice points on the edge, not counting the far end.
+	uint64_t GetEdgePoints(int64_t dx, int64_t dy)
+	{
+		return Math::GCD((uint64_t)std::llabs(dx), (uint64_t)std::llabs(dy));
+	}
+
+	Polygon::LatticeArea MakeLatticeArea(const Int128& twiceSignedArea, const Int128& boundaryPoints)
+	{
+		Polygon::LatticeArea result;
+		result.TwiceSignedArea = twiceSignedArea;
+		result.BoundaryPoints = boundaryPoints;
+
+		// A = I + B / 2 - 1
+		result.InteriorPoints = (twiceSignedArea.Abs() - boundaryPoints + Int128(2)) >> 1;
+		return result;
+	}
+
+	Int128 SumLanes(const __m128i& lanes)
+	{
+		int64_t laneValues[2];
+		_mm_storeu_si128((__m128i*)laneValues, lanes);
+		return Int128(laneValues[0]) + Int128(laneValues[1]);
+	}
+
+	static constexpr uint64_t MAX_SIMD_FLUSH_INTERVAL = 1ULL << 24;
+}
+
+void Polygon::LatticeAccumulator::AddCorner(int64_t x, int64_t y)
+{
+	if (m_cornerCount++ == 0)
+	{
+		m_firstX = m_lastX = x;
+		m_firstY = m_lastY = y;
+		return;
+	}
+
+	m_twiceSignedArea += Int128::Multiply(m_lastX, y) - Int128::Multiply(x, m_lastY);
+	m_boundaryPoints += Int128((int64_t)GetEdgePoints(x - m_lastX, y - m_lastY));
+	m_lastX = x;
+	m_lastY = y;
+}
+
+void Polygon::LatticeAccumulator::AddMove(int64_t dx, int64_t dy)
+{
+	if (m_cornerCount == 0)
+	{
+		AddCorner(0, 0);
+	}
+	AddCorner(m_lastX + dx, m_lastY + dy);
+}
+
+Polygon::LatticeArea Polygon::LatticeAccumulator::Finish() const
+{
+	if (m_cornerCount < 2)
+	{
+		return LatticeArea();
+	}
+
+	const Int128 closingArea = Int128::Multiply(m_lastX, m_firstY) - Int128::Multiply(m_firstX, m_lastY);
+	const Int128 closingBoundary((int64_t)GetEdgePoints(m_firstX - m_lastX, m_firstY - m_lastY));
+	return MakeLatticeArea(m_twiceSignedArea + closingArea, m_boundaryPoints + closingBoundary);
+}
+
+Polygon::LatticeArea Polygon::GetLatticeArea(const std::vector<IntVec2>& corners)
+{
+	static_assert(sizeof(IntVec2) == 2 * sizeof(int32_t), "SSE path loads IntVec2s as packed int32 pairs.");
+
+	const size_t cornerCount = corners.size();
+	if (cornerCount < 2)
+	{
+		return LatticeArea();
+	}
+
+	// Each cross product term is at most 2 * M^2 for M the largest coordinate, so the 64 bit lanes can take this many
+	// before they need to be emptied into the 128 bit totals.
+	uint64_t maxCoordinate = 0;
+	for (const IntVec2& corner : corners)
+	{
+		maxCoordinate = std::max(maxCoordinate, (uint64_t)std::max(std::llabs(corner.x), std::llabs(corner.y)));
+	}
+	const uint64_t maxTerm = std::max(2 * maxCoordinate * maxCoordinate, (uint64_t)1);
+	const uint64_t flushInterval = std::min((uint64_t)INT64_MAX / maxTerm, MAX_SIMD_FLUSH_INTERVAL);
+
+	Int128 twiceSignedArea;
+	Int128 boundaryPoints;
+	size_t edge = 0;
+	if (flushInterval >= 2)
+	{
+		__m128i laneSums = _mm_setzero_si128();
+		uint64_t pendingBoundary = 0;
+		uint64_t pendingTerms = 0;
+
+		// Edges i and i + 1 per step: a = (x0, y0, x1, y1), b = (x1, y1, x2, y2).
+		for (; edge + 2 < cornerCount; edge += 2)
+		{
+			const __m128i a = _mm_loadu_si128((const __m128i*)&corners[edge]);
+			const __m128i b = _mm_loadu_si128((const __m128i*)&corners[edge + 1]);
+
+			// _mm_mul_epi32 multiplies lanes 0 and 2 into 64 bit results.
+			const __m128i forward = _mm_mul_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(3, 3, 1, 1))); // x0 * y1, x1 * y2
+			const __m128i backward = _mm_mul_epi32(b, _mm_shuffle_epi32(a, _MM_SHUFFLE(3, 3, 1, 1))); // x1 * y0, x2 * y1
+			laneSums = _mm_add_epi64(laneSums, _mm_sub_epi64(forward, backward));
+
+			pendingBoundary += GetEdgePoints((int64_t)corners[edge + 1].x - corners[edge].x, (int64_t)corners[edge + 1].y - corners[edge].y);
+			pendingBoundary += GetEdgePoints((int64_t)corners[edge + 2].x - corners[edge + 1].x, (int64_t)corners[edge + 2].y - corners[edge + 1].y);
+
+			if (++pendingTerms == flushInterval)
+			{
+				twiceSignedArea += SumLanes(laneSums);
+				boundaryPoints += Int128((int64_t)pendingBoundary);
+				laneSums = _mm_setzero_si128();
+				pendingBoundary = 0;
+				pendingTerms = 0;
+			}
+		}
+
+		twiceSignedArea += SumLanes(laneSums);
+		boundaryPoints += Int128((int64_t)pendingBoundary);
+	}
+
+	// Whatever's left, including the edge that closes the loop.
+	for (; edge < cornerCount; ++edge)
+	{
+		const IntVec2& from = corners[edge];
+		const IntVec2& to = corners[(edge + 1) % cornerCount];
+		twiceSignedArea += Int128::Multiply(from.x, to.y) - Int128::Multiply(to.x, from.y);
+		boundaryPoints += Int128((int64_t)GetEdgePoints((int64_t)to.x - from.x, (int64_t)to.y - from.y));
+	}
+
+	return MakeLatticeArea(twiceSignedArea, boundaryPoints);
+}
+
+uint64_t Polygon::ScanlineFill(const std::vector<uint8_t>& loopCells, uint32_t width, uint32_t height, std::vector<uint8_t>& outInterior)
+{
+	assert(loopCells.size() == (size_t)width * height);
+	outInterior.assign(loopCells.size(), 0);
+
+	uint64_t interiorCount = 0;
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		const size_t rowStart = (size_t)y * width;
+		uint8_t inside = 0;
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			const uint8_t cell = loopCells[rowStart + x];
+			inside ^= (cell & SCAN_CROSSING) ? 1 : 0;
+
+			const uint8_t interior = inside & ((cell & SCAN_BOUNDARY) ? 0 : 1);
+			outInterior[rowStart + x] = interior;
+			interiorCount += interior;
+		}
+	}
+
+	return interiorCount;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <assert.h>
+#include <cstdint>
+#include <vector>
+#include "Int128.h"
+#include "IntVec.h"
+
+namespace Polygon
+{
+	// Area / point counts for a closed polygon with integer corners. Everything is 128 bit, so even corners out near the
+	// edge of int64 can't overflow.
+	struct LatticeArea
+	{
+		Int128 TwiceSignedArea; // Shoelace sum, positive for counter clockwise (y up).
+		Int128 BoundaryPoints; // Lattice points on the edges.
+		Int128 InteriorPoints; // Lattice points strictly inside (Pick's).
+
+		Int128 GetTotalPoints() const { return BoundaryPoints + InteriorPoints; }
+	};
+
+	// Shoelace + Pick's, one corner at a time, so a long walk never has to be kept around as a vertex list.
+	// The loop closes itself (last corner back to the first) so don't repeat the first corner. Corners can be collinear,
+	// edges don't have to be axis aligned, but each edge's delta has to fit in an int64. Less than two corners is an empty area.
+	class LatticeAccumulator
+	{
+	public:
+		void AddCorner(int64_t x, int64_t y);
+
+		template<typename VecType>
+		void AddCorner(const VecType& corner) { AddCorner((int64_t)corner.x, (int64_t)corner.y); }
+
+		// Walks from the previous corner (or the origin if this is the first move).
+		void AddMove(int64_t dx, int64_t dy);
+
+		LatticeArea Finish() const;
+
+	private:
+		Int128 m_twiceSignedArea;
+		Int128 m_boundaryPoints;
+		int64_t m_firstX = 0;
+		int64_t m_firstY = 0;
+		int64_t m_lastX = 0;
+		int64_t m_lastY = 0;
+		uint64_t m_cornerCount = 0;
+	};
+
+	template<typename VecType>
+	LatticeArea GetLatticeArea(const std::vector<VecType>& corners)
+	{
+		LatticeAccumulator accumulator;
+		for (const VecType& corner : corners)
+		{
+			accumulator.AddCorner(corner);
+		}
+		return accumulator.Finish();
+	}
+
+	// 32 bit corners get the cross products done two edges at a time in SSE, only spilling to 128 bits every so often.
+	LatticeArea GetLatticeArea(const std::vector<IntVec2>& corners);
+
+	// Flags for ScanlineFill's loop bitmap.
+	static constexpr uint8_t SCAN_BOUNDARY = 1 << 0; // Cell is part of the loop.
+	static constexpr uint8_t SCAN_CROSSING = 1 << 1; // Loop cell that connects to the row above, so walking past it flips inside / outside.
+
+	// Row scanline parity fill over a width x height loop bitmap. Only counting upward connections means a horizontal run
+	// flips parity once for an S bend and zero times for a U bend, which is exactly what we want.
+	// Writes 1 for every interior (non loop) cell into outInterior and returns how many there were.
+	uint64_t ScanlineFill(const std::vector<uint8_t>& loopCells, uint32_t width, uint32_t height, std::vector<uint8_t>& outInterior);
+} // Polygon
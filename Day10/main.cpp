@@ -9,6 +9,7 @@
 #include "ACUtils/Enum.h"
 #include "ACUtils/IntVec.h"
 #include "ACUtils/Math.h"
+#include "ACUtils/Polygon.h"
 #include "ACUtils/StringUtil.h"
 #include <queue>
 #include <inttypes.h>
@@ -157,22 +158,19 @@ private:
 		AdventGUIInstance::PartOne(context);
 	}
 
-	bool IsPointInPoly(const IntVec2& pos, const std::vector<IntVec2>& polyVerts) const
+	// Interior cells by scanline parity over the loop, only needed when we want the actual cells rather than a count.
+	uint64_t FillInterior(std::vector<uint8_t>& outInterior) const
 	{
-		bool contained = false;
-
-		size_t i = 0;
-		size_t j = polyVerts.size() - 1;
-
-		for (; i < polyVerts.size(); j = i++)
+		std::vector<uint8_t> loopCells(m_Map.size(), 0);
+		for (size_t i = 0; i < m_Map.size(); ++i)
 		{
-			if ((polyVerts[i].y > pos.y) != (polyVerts[j].y > pos.y) && pos.x < (polyVerts[j].x - polyVerts[i].x) * (pos.y - polyVerts[i].y) / (polyVerts[j].y - polyVerts[i].y) + polyVerts[i].x)
+			if (m_Distances[i] != INT_MAX)
 			{
-				contained = !contained;
+				loopCells[i] = Polygon::SCAN_BOUNDARY | (((m_Map[i] & ExitDir::North) != ExitDir::None) ? Polygon::SCAN_CROSSING : 0);
 			}
 		}
 
-		return contained;
+		return Polygon::ScanlineFill(loopCells, m_MapWidth, (uint32_t)(m_Map.size() / m_MapWidth), outInterior);
 	}
 
 	virtual void PartTwo(const AdventGUIContext& context) override
@@ -189,8 +187,6 @@ private:
 		ExitDir currentDir = (ExitDir)(1 << Bits::CountTrailingZeros((uint32_t)GetPipe(m_StartPos)));
 		ExitDir nextDir;
 
-		IntAABB2D bounds(m_StartPos, 0);
-		
 		IntVec2 loc = m_StartPos + GetOffset(currentDir);
 		while (loc != m_StartPos)
 		{
@@ -198,44 +194,17 @@ private:
 			if (nextDir != currentDir)
 			{
 				m_PipeVerts.push_back(loc);
-				bounds = bounds.ExpandToContain(loc);
 			}
 			currentDir = nextDir;
 			loc += GetOffset(currentDir);
 		}
-		m_PipeVerts.push_back(m_StartPos); // Dupe the first.
-
-		uint32_t totalArea = 0;
-		IntVec2 iterPos;
-		for (size_t i = 0; i < m_Map.size(); ++i)
-		{
-			iterPos = IntVec2(i % m_MapWidth, i / m_MapWidth);
-			if (!bounds.Contains(iterPos))
-			{
-				continue;
-			}
 
-			bool IsOnPoly = false;
+		// Shoelace + Pick's over the corners, the loop itself is the boundary.
+		const Polygon::LatticeArea area = Polygon::GetLatticeArea(m_PipeVerts);
+		const uint32_t totalArea = (uint32_t)area.InteriorPoints.ToInt64();
 
-			for (size_t i = 0; i <  m_PipeVerts.size() -1; ++i)
-			{
-				int32_t minLineX = std::min(m_PipeVerts[i].x, m_PipeVerts[i + 1].x);
-				int32_t maxLineX = std::max(m_PipeVerts[i].x, m_PipeVerts[i + 1].x);
-				int32_t minLineY = std::min(m_PipeVerts[i].y, m_PipeVerts[i + 1].y);
-				int32_t maxLineY = std::max(m_PipeVerts[i].y, m_PipeVerts[i + 1].y);
-
-				if (iterPos.x >= minLineX && iterPos.x <= maxLineX && iterPos.y >= minLineY && iterPos.y <= maxLineY)
-				{
-					IsOnPoly = true;
-					break;
-				}
-			}
-
-			if (!IsOnPoly && IsPointInPoly(iterPos, m_PipeVerts))
-			{
-				++totalArea;
-			}
-		}
+		std::vector<uint8_t> interiorCells;
+		assert(Int128((int64_t)FillInterior(interiorCells)) == area.InteriorPoints); // Both ways of counting should agree.
 
 		Log("Total Area: %u,took %fms to execute", totalArea, stopWatch.Stop());
 
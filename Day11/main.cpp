@@ -3,7 +3,6 @@
 
 #include "AdventGUI/AdventGUI.h"
 
-#include "ACUtils/IntVec.h"
 #include "ACUtils/StringUtil.h"
 #include <inttypes.h>
 #include <vector>
@@ -17,97 +16,64 @@ private:
 	virtual void ParseInput(FileStreamReader& fileReader) override
 	{
 		// Parse Input. Input never changes between parts of a problem.
+		// Distances split per axis, so all we need is how many galaxies sit in each column and each row.
 		std::string line;
-		size_t rowIdx = 0;
-		size_t colIdx = 0;
 		while (!fileReader.IsEOF())
 		{
 			line = fileReader.ReadLine();
-			
-			// Track empty space as we go.
-			if (m_EmptyRowCol.empty())
+			if (line.empty())
 			{
-				m_MapWidth = line.size();
-				m_EmptyRowCol.reserve(m_MapWidth * 2); // Assume squared dimensions
-				while (m_EmptyRowCol.size() != m_MapWidth * 2)
-				{
-					m_EmptyRowCol.emplace_back(true);
-				}
+				continue;
 			}
 
-			for (char c : line)
+			if (m_ColumnCounts.empty())
 			{
-				if (c != '.')
-				{
-					colIdx = m_RawMap.size() % m_MapWidth;
-					rowIdx = m_RawMap.size() / m_MapWidth;
-
-					m_Galaxies.push_back(IntVec2((int32_t)colIdx, (int32_t)rowIdx));
+				m_ColumnCounts.assign(line.size(), 0);
+			}
+			assert(line.size() == m_ColumnCounts.size());
 
-					// Mark col
-					m_EmptyRowCol[colIdx] = false;
-					// Mark row
-					m_EmptyRowCol[m_MapWidth + rowIdx] = false;
+			uint32_t rowCount = 0;
+			for (size_t colIdx = 0; colIdx < line.size(); ++colIdx)
+			{
+				if (line[colIdx] != '.')
+				{
+					++m_ColumnCounts[colIdx];
+					++rowCount;
 				}
-				m_RawMap.push_back(c);
 			}
+			m_RowCounts.push_back(rowCount);
 		}
-
 	}
 
-	uint32_t GetManhattanDistance(const IntVec2& a, const IntVec2& b) const
+	// Sum of |a - b| over every pair of galaxies along one axis, after every empty line along it grows to expansionFactor
+	// lines. Walking the axis in order, each galaxy is k * position - (sum of the k positions before it) away from the
+	// galaxies already seen, so it's O(width) with no pairs and no sort.
+	uint64_t GetExpandedDistanceSum(const std::vector<uint32_t>& galaxyCounts, uint64_t expansionFactor) const
 	{
-		return abs(a.x - b.x) + abs(a.y - b.y);
+		uint64_t totalSum = 0;
+		uint64_t position = 0;
+		uint64_t galaxiesSeen = 0;
+		uint64_t positionSum = 0;
+		for (uint32_t count : galaxyCounts)
+		{
+			totalSum += count * (galaxiesSeen * position - positionSum);
+			galaxiesSeen += count;
+			positionSum += count * position;
+			position += count == 0 ? expansionFactor : 1;
+		}
+
+		return totalSum;
 	}
 
-	uint64_t GetManhattanDistance64(const Int64Vec2& a, const Int64Vec2& b) const
+	uint64_t GetExpandedDistanceSum(uint64_t expansionFactor) const
 	{
-		return abs(a.x - b.x) + abs(a.y - b.y);
+		return GetExpandedDistanceSum(m_ColumnCounts, expansionFactor) + GetExpandedDistanceSum(m_RowCounts, expansionFactor);
 	}
 
 	virtual void PartOne(const AdventGUIContext& context) override
 	{
 		// Part One
-		int32_t xOffset = 0;
-		int32_t yOffset = 0;
-		std::vector<IntVec2> offsetGalaxies;
-		offsetGalaxies.reserve(m_Galaxies.size());
-
-		for (const IntVec2& galaxy : m_Galaxies)
-		{
-			xOffset = 0;
-			yOffset = 0;
-			for (int32_t i = 0; i < m_MapWidth; ++i)
-			{
-				if (m_EmptyRowCol[i] && i > galaxy.x)
-				{
-					++xOffset;
-				}
-			}
-
-			for (int32_t i = 0; i < m_MapWidth; ++i)
-			{
-				if (m_EmptyRowCol[m_MapWidth + i] && i > galaxy.y)
-				{
-					++yOffset;
-				}
-			}
-
-			offsetGalaxies.push_back(galaxy - IntVec2(xOffset, yOffset));
-		}
-
-		uint32_t totalSum = 0;
-		uint32_t distance = 0;
-		for (size_t i = 0; i < offsetGalaxies.size(); ++i)
-		{
-			for (size_t j = i + 1; j < offsetGalaxies.size(); ++j)
-			{
-				distance = GetManhattanDistance(offsetGalaxies[i], offsetGalaxies[j]);
-				totalSum += distance;
-			}
-		}
-
-		Log("Total Sum of Smallest Distances = %u", totalSum);
+		Log("Total Sum of Smallest Distances = %" PRIu64, GetExpandedDistanceSum(PART_ONE_EXPANSION));
 
 		// Done.
 		AdventGUIInstance::PartOne(context);
@@ -116,57 +82,17 @@ private:
 	virtual void PartTwo(const AdventGUIContext& context) override
 	{
 		// Part Two
-		int64_t xOffset = 0;
-		int64_t yOffset = 0;
-		std::vector<Int64Vec2> offsetGalaxies;
-		offsetGalaxies.reserve(m_Galaxies.size());
-
-		for (const IntVec2& galaxy : m_Galaxies)
-		{
-			xOffset = 0;
-			yOffset = 0;
-			for (int32_t i = 0; i < m_MapWidth; ++i)
-			{
-				if (m_EmptyRowCol[i] && i > galaxy.x)
-				{
-					++xOffset;
-				}
-			}
-
-			for (int32_t i = 0; i < m_MapWidth; ++i)
-			{
-				if (m_EmptyRowCol[m_MapWidth + i] && i > galaxy.y)
-				{
-					++yOffset;
-				}
-			}
-
-			xOffset =  (xOffset * 1000000) - xOffset;
-			yOffset =  (yOffset * 1000000) - yOffset;
+		Log("Total Sum of Smallest Distances = %" PRIu64, GetExpandedDistanceSum(PART_TWO_EXPANSION));
 
-			offsetGalaxies.push_back(Int64Vec2((int64_t)galaxy.x, (int64_t)galaxy.y) - Int64Vec2((int64_t)xOffset, (int64_t)yOffset));
-		}
-
-		uint64_t totalSum = 0;
-		uint64_t distance = 0;
-		for (size_t i = 0; i < offsetGalaxies.size(); ++i)
-		{
-			for (size_t j = i + 1; j < offsetGalaxies.size(); ++j)
-			{
-				distance = GetManhattanDistance64(offsetGalaxies[i], offsetGalaxies[j]);
-				totalSum += distance;
-			}
-		}
-
-		Log("Total Sum of Smallest Distances = %" PRIu64, totalSum);
 		// Done.
 		AdventGUIInstance::PartTwo(context);
 	}
 	
-	size_t m_MapWidth;
-	std::vector<char> m_RawMap;
-	std::vector<bool> m_EmptyRowCol;
-	std::vector<IntVec2> m_Galaxies;
+	static constexpr uint64_t PART_ONE_EXPANSION = 2;
+	static constexpr uint64_t PART_TWO_EXPANSION = 1000000;
+
+	std::vector<uint32_t> m_ColumnCounts;
+	std::vector<uint32_t> m_RowCounts;
 };
 
 int main()
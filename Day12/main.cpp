@@ -6,11 +6,12 @@
 #include "ACUtils/Math.h"
 #include "ACUtils/Debug.h"
 #include "ACUtils/Hash.h"
+#include "ACUtils/Int128.h"
+#include "ACUtils/Parallel.h"
 #include "ACUtils/StringUtil.h"
 #include <stack>
 #include <vector>
 #include <unordered_set>
-#include <inttypes.h>
 
 class AdventDay : public AdventGUIInstance
 {
@@ -19,6 +20,10 @@ public:
 	: AdventGUIInstance(params)
 	{};
 private:
+	// How many copies of each line part two unfolds into. The puzzle input is folded 5 times, bigger workloads (x20) only need
+	// this changed. Counts grow roughly geometrically per fold, so they're kept in 128 bits and anything past that gets reported.
+	static constexpr uint32_t UNFOLD_COUNT = 5;
+
 	struct Spring
 	{
 		Spring(const std::string& raw)
@@ -35,141 +40,144 @@ private:
 			{
 				groups.push_back(atoi(digit.c_str()));
 			}
+
+			BuildPrefixCounts();
 		}
 
 		Spring(const std::string& raw, const std::vector<uint32_t>& counts)
 		: springStr(raw),
 		groups(counts)
 		{
+			BuildPrefixCounts();
 		}
 
 		inline size_t GetLength() const { return springStr.size(); }
 		inline size_t GetGroupLength(uint32_t index) const { return groups[index]; }
 
-		bool CheckGroupAgainstIndex(uint32_t index, uint32_t groupIndex) const
+		// Number of '.' / '#' in the range [start, end)
+		inline uint32_t CountOperational(uint32_t start, uint32_t end) const { return operationalPrefix[end] - operationalPrefix[start]; }
+		inline uint32_t CountDamaged(uint32_t start, uint32_t end) const { return damagedPrefix[end] - damagedPrefix[start]; }
+
+		// Can a group of groupLength '#' start at index? It needs to fit, can't cover a '.', and can't be followed by a '#'.
+		bool CanPlaceGroupAt(uint32_t index, uint32_t groupLength) const
 		{
-			uint32_t count = groups[groupIndex] - 1;
-			for (; count; --count)
+			const uint32_t groupEnd = index + groupLength;
+			if (groupEnd > (uint32_t)springStr.size())
 			{
-				// End goes past our string, invalid.
-				if (index + count >= springStr.size())
-				{
-					return false;
-				}
+				return false;
+			}
 
-				// We run into a '.'. Invalid.
-				if (springStr[index + count] == '.')
-				{
-					return false;
-				}
+			if (CountOperational(index, groupEnd) != 0)
+			{
+				return false;
 			}
 
-			// Make sure our ending character IS NOT a '#', otherwise we're good.
-			return (springStr[index + groups[groupIndex]] != '#');
+			return groupEnd == (uint32_t)springStr.size() || springStr[groupEnd] != '#';
 		}
 
 		std::string springStr;
 		std::vector<uint32_t> groups;
-	};
-
-	uint64_t MakeHash(uint32_t strIndex, uint32_t groupIndex) const
-	{
-		return (uint64_t)groupIndex << 32ULL | strIndex;
-	}
+		std::vector<uint32_t> operationalPrefix;
+		std::vector<uint32_t> damagedPrefix;
 
-	uint64_t Solve(const Spring& spring, uint32_t strIndex, uint32_t groupIndex, std::unordered_map<uint64_t, uint64_t>& cache) const
-	{
-		std::unordered_map<uint64_t, uint64_t>::const_iterator itCache = cache.find(MakeHash(strIndex, groupIndex));
-		if (itCache != cache.end())
-		{
-			return itCache->second;
-		}
-		uint64_t cacheValue = InternalSolve(spring, strIndex, groupIndex, cache);
-		if (cache.find(MakeHash(strIndex, groupIndex)) == cache.end())
+	private:
+		void BuildPrefixCounts()
 		{
-			cache.insert(std::make_pair(MakeHash(strIndex, groupIndex), cacheValue));
+			operationalPrefix.assign(springStr.size() + 1, 0);
+			damagedPrefix.assign(springStr.size() + 1, 0);
+			for (size_t i = 0; i < springStr.size(); ++i)
+			{
+				operationalPrefix[i + 1] = operationalPrefix[i] + (springStr[i] == '.' ? 1 : 0);
+				damagedPrefix[i + 1] = damagedPrefix[i] + (springStr[i] == '#' ? 1 : 0);
+			}
 		}
-		return cacheValue;
-	}
+	};
 
-	uint64_t InternalSolve(const Spring& spring, uint32_t strIndex, uint32_t groupIndex, std::unordered_map<uint64_t, uint64_t>& cache) const
+	// Bottom up DP over (strIndex, groupIndex).
+	// row[i] is the number of ways to place groups [groupIndex, end) into springStr[i, end). We walk the groups from last to first,
+	// and each row only depends on itself and the row for groupIndex + 1, so we just roll between two rows in the scratch buffer.
+	// Sets outOverflowed (and leaves it set) if the count doesn't fit in an Int128.
+	Int128 Solve(const Spring& spring, std::vector<Int128>& scratch, bool& outOverflowed) const
 	{
-		// Success?
-		// Reached the end and nothing left for us to do.
-		if (strIndex == spring.springStr.size() || strIndex == (spring.springStr.size() + 1))
-		{
-			return groupIndex == spring.groups.size() ? 1 : 0;
-		}
+		const uint32_t length = (uint32_t)spring.GetLength();
+		const uint32_t rowSize = length + 1;
+		scratch.resize(rowSize * 2); // Only allocates if a previous spring was shorter.
 
-		// Useless ., just skip past it.
-		while (strIndex < (uint32_t)spring.springStr.size() && spring.springStr[strIndex] == '.')
-		{
-			// Just Increment
-			strIndex++;
-		}
+		Int128* nextRow = scratch.data();
+		Int128* currentRow = scratch.data() + rowSize;
 
-		// Too big an index? Bounce.
-		if (strIndex > spring.springStr.size())
+		// All groups placed, we're only valid if there are no '#' left.
+		for (uint32_t i = 0; i <= length; ++i)
 		{
-			return 0;
+			nextRow[i] = Int128(spring.CountDamaged(i, length) == 0 ? 1 : 0);
 		}
 
-		// Finished our groups but the remaining entries are valid.
-		if (groupIndex == spring.groups.size())
+		for (uint32_t groupIndex = (uint32_t)spring.groups.size(); groupIndex-- > 0;)
 		{
-			bool success = true;
-			while (strIndex < spring.springStr.size())
+			const uint32_t groupLength = (uint32_t)spring.GetGroupLength(groupIndex);
+
+			// Out of string, but still have groups to place.
+			currentRow[length] = Int128();
+			for (uint32_t strIndex = length; strIndex-- > 0;)
 			{
-				if (spring.springStr[strIndex] == '#')
+				Int128 ways;
+
+				// Treat as a '.'
+				if (spring.springStr[strIndex] != '#')
 				{
-					success = false;
-					break;
+					ways += currentRow[strIndex + 1];
 				}
-				++strIndex;
+
+				// Treat as the start of our group (plus the '.' separator after it).
+				if (spring.CanPlaceGroupAt(strIndex, groupLength))
+				{
+					ways += nextRow[std::min(strIndex + groupLength + 1, length)];
+				}
+
+				// Everything's non negative, so wrapping shows up as a sign flip.
+				outOverflowed |= ways.IsNegative();
+
+				currentRow[strIndex] = ways;
 			}
 
-			return success ? 1 : 0;
+			std::swap(nextRow, currentRow);
 		}
 
-		// Too many groups? Skip
-		if (groupIndex >= spring.groups.size())
-		{
-			return 0;
-		}
+		return nextRow[0];
+	}
+
+	// Solves every spring across all our worker threads, each worker reuses its own scratch rows.
+	// False if any count (or the total) overflowed.
+	bool SolveAll(const std::vector<Spring>& springs, Int128& outTotal) const
+	{
+		std::vector<std::vector<Int128>> workerScratch(Parallel::GetWorkerCount(springs.size()));
+		std::vector<Int128> variations(springs.size());
+		std::vector<uint8_t> overflowed(springs.size(), 0);
 
-		// Process choices
-		uint64_t cacheValue = 0;	
-		if (spring.springStr[strIndex] == '#')
+		Parallel::ForEach(springs.size(), [&](uint32_t workerIndex, size_t springIndex)
 		{
-			if (spring.CheckGroupAgainstIndex(strIndex, groupIndex))
-			{
-				// Success, increment by group length
-				cacheValue = Solve(spring, strIndex + (uint32_t)spring.GetGroupLength(groupIndex) + 1, groupIndex + 1, cache);
-			}
-			else
-			{
-				// Group failed, bounce out.
-				return 0;
-			}
-		}
-		else if (spring.springStr[strIndex] == '?')
+			bool springOverflowed = false;
+			variations[springIndex] = Solve(springs[springIndex], workerScratch[workerIndex], springOverflowed);
+			overflowed[springIndex] = springOverflowed ? 1 : 0;
+		});
+
+		bool anyOverflowed = false;
+		outTotal = Int128();
+		for (size_t i = 0; i < springs.size(); ++i)
 		{
-			// Does turning this into a # cause the group to finish?
-			if (spring.CheckGroupAgainstIndex(strIndex, groupIndex))
-			{
-				// Solve as both a '#' and a '.'
-				cacheValue = Solve(spring, strIndex + (uint32_t)spring.GetGroupLength(groupIndex) + 1, groupIndex + 1, cache) + 
-				Solve(spring, strIndex + 1, groupIndex, cache);
-			}
-			else
+			if (overflowed[i])
 			{
-				// Can only be a '.'
-				cacheValue = Solve(spring, strIndex + 1, groupIndex, cache);
+				Log("---Spring %s overflowed 128 bits", springs[i].springStr.c_str());
+				anyOverflowed = true;
+				continue;
 			}
+
+			Log("---Solved Spring %s [%s]", springs[i].springStr.c_str(), variations[i].ToString().c_str());
+			outTotal += variations[i];
+			anyOverflowed |= outTotal.IsNegative();
 		}
 
-		// Return value
-		return cacheValue;
+		return !anyOverflowed;
 	}
 
 	virtual void ParseInput(FileStreamReader& fileReader) override
@@ -185,7 +193,7 @@ private:
 			std::string largeSpring = m_Springs.back().springStr;
 			std::vector<uint32_t> counts = m_Springs.back().groups;
 
-			for (uint32_t i = 0; i < 4; ++i)
+			for (uint32_t i = 1; i < UNFOLD_COUNT; ++i)
 			{
 				largeSpring += ("?" + m_Springs.back().springStr);
 				counts.insert(counts.end(), m_Springs.back().groups.begin(), m_Springs.back().groups.end());
@@ -198,20 +206,15 @@ private:
 	virtual void PartOne(const AdventGUIContext& context) override
 	{
 		// Part One
-		std::unordered_map<uint64_t, uint64_t> cache;
-		uint64_t totalValues = 0;
-		uint64_t variations = 0;
-
-		for (const Spring& spring : m_Springs)
+		Int128 totalValues;
+		if (SolveAll(m_Springs, totalValues))
 		{
-			cache.clear();
-			variations = 0;
-			variations = Solve(spring, 0, 0, cache);
-			Log("---Solved Spring %s [%" PRIu64"]", spring.springStr.c_str(), variations);
-			totalValues += variations;
+			Log("Total Perms: %s", totalValues.ToString().c_str());
+		}
+		else
+		{
+			Log("Total Perms overflowed 128 bits.");
 		}
-
-		Log("Total Perms: %u", totalValues);
 
 		// Done.
 		AdventGUIInstance::PartOne(context);
@@ -219,20 +222,16 @@ private:
 
 	virtual void PartTwo(const AdventGUIContext& context) override
 	{	
-		std::unordered_map<uint64_t, uint64_t> cache;
-		uint64_t totalValues = 0;
-		uint64_t variations = 0;
-		for (const Spring& spring : m_LargeSprings)
+		Int128 totalValues;
+		if (SolveAll(m_LargeSprings, totalValues))
 		{
-			cache.clear();
-			variations = 0;
-			variations = Solve(spring, 0, 0, cache);
-			Log("---Solved Spring %s [%" PRIu64"]", spring.springStr.c_str(), variations);
-			totalValues += variations;
-
+			Log("Total Perms: %s", totalValues.ToString().c_str());
+		}
+		else
+		{
+			Log("Total Perms overflowed 128 bits.");
 		}
 
-		Log("Total Perms: %" PRIu64, totalValues);
 		// Done.
 		AdventGUIInstance::PartTwo(context);
 	}
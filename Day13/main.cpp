@@ -3,14 +3,123 @@
 
 #include "AdventGUI/AdventGUI.h"
 
+#include "ACUtils/Bit.h"
 #include "ACUtils/Math.h"
-#include "ACUtils/Debug.h"
-#include "ACUtils/Hash.h"
 #include "ACUtils/StringUtil.h"
 #include <algorithm>
 #include <vector>
-#include <unordered_set>
-#include <inttypes.h>
+#include <cstring>
+
+// Every pattern's rows and columns as bit lines, all in one flat word buffer. Each line set is stored forwards and then
+// backwards, so for a mirror after line m the pairs (m - 1 - k, m + k) are two contiguous spans: forwards from line m and
+// backwards from line (count - m). Checking a candidate is then one straight XOR + popcount run with no index juggling,
+// and lines can be as long as they like.
+class ReflectionBatch
+{
+public:
+	// Rows of '#' / '.', all the same length.
+	void AddPattern(const std::vector<std::string>& lines)
+	{
+		assert(!lines.empty());
+		const uint32_t height = (uint32_t)lines.size();
+		const uint32_t width = (uint32_t)lines[0].size();
+
+		m_rowSets.push_back(AddLineSet(height, width, [&lines](uint32_t line, uint32_t cell) { return lines[line][cell] == '#'; }));
+		m_colSets.push_back(AddLineSet(width, height, [&lines](uint32_t line, uint32_t cell) { return lines[cell][line] == '#'; }));
+	}
+
+	// Score per pattern: lines before the mirror, rows count 100x. Clean wants a perfect mirror, smudged wants a mirror with
+	// exactly one cell off. Both come out of the same pass. 0 if there's no such mirror.
+	void FindReflections(std::vector<uint32_t>& outClean, std::vector<uint32_t>& outSmudged) const
+	{
+		outClean.assign(m_rowSets.size(), 0);
+		outSmudged.assign(m_rowSets.size(), 0);
+		for (size_t pattern = 0; pattern < m_rowSets.size(); ++pattern)
+		{
+			uint32_t rowClean = 0;
+			uint32_t rowSmudged = 0;
+			uint32_t colClean = 0;
+			uint32_t colSmudged = 0;
+			FindMirrors(m_rowSets[pattern], rowClean, rowSmudged);
+			FindMirrors(m_colSets[pattern], colClean, colSmudged);
+
+			outClean[pattern] = rowClean != 0 ? rowClean * 100 : colClean;
+			outSmudged[pattern] = rowSmudged != 0 ? rowSmudged * 100 : colSmudged;
+		}
+	}
+
+	size_t GetPatternCount() const { return m_rowSets.size(); }
+
+private:
+	struct LineSet
+	{
+		size_t offset; // Into m_words, forward lines then reversed lines.
+		uint32_t lineCount;
+		uint32_t wordsPerLine;
+	};
+
+	template<typename IsSetFunc>
+	LineSet AddLineSet(uint32_t lineCount, uint32_t lineLength, IsSetFunc isSet)
+	{
+		LineSet lineSet;
+		lineSet.offset = m_words.size();
+		lineSet.lineCount = lineCount;
+		lineSet.wordsPerLine = (lineLength + 63) / 64;
+
+		m_words.resize(m_words.size() + (size_t)lineCount * lineSet.wordsPerLine * 2, 0);
+		uint64_t* forward = &m_words[lineSet.offset];
+		uint64_t* reversed = forward + (size_t)lineCount * lineSet.wordsPerLine;
+		for (uint32_t line = 0; line < lineCount; ++line)
+		{
+			uint64_t* words = forward + (size_t)line * lineSet.wordsPerLine;
+			for (uint32_t cell = 0; cell < lineLength; ++cell)
+			{
+				if (isSet(line, cell))
+				{
+					words[cell / 64] |= 1ULL << (cell % 64);
+				}
+			}
+
+			memcpy(reversed + (size_t)(lineCount - 1 - line) * lineSet.wordsPerLine, words, lineSet.wordsPerLine * sizeof(uint64_t));
+		}
+
+		return lineSet;
+	}
+
+	// Differing bits between two spans, bailing once we're past the cap.
+	static uint32_t CountMismatches(const uint64_t* a, const uint64_t* b, size_t wordCount, uint32_t cap)
+	{
+		uint32_t mismatches = 0;
+		for (size_t i = 0; i < wordCount && mismatches <= cap; ++i)
+		{
+			mismatches += Bits::PopCount64(a[i] ^ b[i]);
+		}
+		return mismatches;
+	}
+
+	void FindMirrors(const LineSet& lineSet, uint32_t& outClean, uint32_t& outSmudged) const
+	{
+		const uint64_t* forward = &m_words[lineSet.offset];
+		const uint64_t* reversed = forward + (size_t)lineSet.lineCount * lineSet.wordsPerLine;
+		for (uint32_t mirror = 1; mirror < lineSet.lineCount && (outClean == 0 || outSmudged == 0); ++mirror)
+		{
+			const uint32_t pairs = std::min(mirror, lineSet.lineCount - mirror);
+			const uint32_t mismatches = CountMismatches(forward + (size_t)mirror * lineSet.wordsPerLine, reversed + (size_t)(lineSet.lineCount - mirror) * lineSet.wordsPerLine, (size_t)pairs * lineSet.wordsPerLine, 1);
+			if (mismatches == 0 && outClean == 0)
+			{
+				outClean = mirror;
+			}
+			else if (mismatches == 1 && outSmudged == 0)
+			{
+				outSmudged = mirror;
+			}
+		}
+	}
+
+	std::vector<uint64_t> m_words;
+	std::vector<LineSet> m_rowSets;
+	std::vector<LineSet> m_colSets;
+};
 
 class AdventDay : public AdventGUIInstance
 {
@@ -23,55 +132,43 @@ private:
 	{
 		// Parse Input. Input never changes between parts of a problem.
 		std::string line;
-		std::vector<char> currentMap;
-		uint32_t rowWidth = 0;
+		std::vector<std::string> currentPattern;
 		while (!fileReader.IsEOF())
 		{
 			line = fileReader.ReadLine();
 			if (line.empty())
 			{
-				if (currentMap.size())
+				if (currentPattern.size())
 				{
-					m_Maps.emplace_back(currentMap, rowWidth);
+					m_Batch.AddPattern(currentPattern);
 				}
-				currentMap.clear();
-				rowWidth = 0;
+				currentPattern.clear();
 			}
 			else
 			{
-				if (rowWidth == 0)
-				{
-					rowWidth = (uint32_t)line.size();
-				}
-				assert(rowWidth == (uint32_t)line.size());
-				currentMap.insert(currentMap.end(), line.begin(), line.end());
+				assert(currentPattern.empty() || currentPattern[0].size() == line.size());
+				currentPattern.push_back(line);
 			}
 		}
 
 		// Grab any remainder.
-		if (currentMap.size())
+		if (currentPattern.size())
 		{
-			m_Maps.emplace_back(currentMap, rowWidth);
-			currentMap.clear();
-			rowWidth = 0;
+			m_Batch.AddPattern(currentPattern);
 		}
+
+		// Both kinds of mirror come out of the one pass.
+		m_Batch.FindReflections(m_CleanScores, m_SmudgedScores);
 	}
 
 	virtual void PartOne(const AdventGUIContext& context) override
 	{
 		// Part One
-		EReflectionType foundReflection = EReflectionType::None;
-		uint32_t outIndex = 0;
-		uint32_t outDistance = 0;
 		uint32_t totalScore = 0;
-		constexpr uint32_t multiplier[] = {0, 1, 100};
-		for (const Map& currentMap : m_Maps)
+		for (uint32_t score : m_CleanScores)
 		{
-			foundReflection = FindReflectionIndex(currentMap, outIndex, outDistance);
-			Log("Map [%u x %u] Index %u Distance %u Orientation %s", currentMap.width, currentMap.height, outIndex, outDistance, foundReflection == EReflectionType::Horizontal ? "Horizontal" : "Vertical");
-			assert(foundReflection != EReflectionType::None);
-			m_PartOneHistory.push_back(outIndex);
-			totalScore += outDistance * multiplier[static_cast<uint8_t>(foundReflection)];
+			assert(score != 0);
+			totalScore += score;
 		}
 
 		Log("Total %u", totalScore);
@@ -83,17 +180,11 @@ private:
 	virtual void PartTwo(const AdventGUIContext& context) override
 	{	
 		// Part Two
-		EReflectionType foundReflection = EReflectionType::None;
-		uint32_t outIndex = 0;
-		uint32_t outDistance = 0;
 		uint32_t totalScore = 0;
-		constexpr uint32_t multiplier[] = { 0, 1, 100 };
-		for (const Map& currentMap : m_Maps)
+		for (uint32_t score : m_SmudgedScores)
 		{
-			foundReflection = FindReflectionIndex(currentMap, outIndex, outDistance, true);
-			Log("Map (SMUDGED) [%u x %u] Index %u Distance %u Orientation %s", currentMap.width, currentMap.height, outIndex, outDistance, foundReflection == EReflectionType::Horizontal ? "Horizontal" : "Vertical");
-			assert(foundReflection != EReflectionType::None);
-			totalScore += outDistance * multiplier[static_cast<uint8_t>(foundReflection)];
+			assert(score != 0);
+			totalScore += score;
 		}
 
 		Log("Total %u", totalScore);
@@ -102,169 +193,9 @@ private:
 		AdventGUIInstance::PartTwo(context);
 	}
 
-	enum class EReflectionType : uint8_t
-	{
-		None = 0,
-		Vertical,
-		Horizontal
-	};
-
-	struct Map
-	{
-		Map(): width(0), height(0), map(){};
-		Map(const std::vector<char>& _map, uint32_t _width) : width(_width), height((uint32_t)_map.size() / _width), map(_map)
-		{
-			// Build rows
-			uint64_t temp = 0;
-			for (uint32_t i = 0; i < height; ++i)
-			{
-				temp = 0;
-				for (uint32_t j = 0; j < width; ++j)
-				{
-					if (map[i * width + j] == '#')
-					{
-						temp |= 1ULL << j;
-					}
-				}
-				rows.emplace_back(temp);
-			}
-
-			// build cols
-			for (uint32_t i = 0; i < width; ++i)
-			{
-				temp = 0;
-				for (uint32_t j = 0; j < height; ++j)
-				{
-					if (map[j * width + i] == '#')
-					{
-						temp |= 1ULL << j;
-					}
-				}
-				cols.emplace_back(temp);
-			}
-		}
-
-		// Check for a Horizontal Line
-		bool CheckRows(uint32_t LHS, uint32_t RHS) const
-		{
-			assert(LHS < height && RHS < height);
-			return rows[LHS] == rows[RHS];
-		}
-
-		bool CanSmudgeRows(uint32_t LHS, uint32_t RHS) const
-		{
-			return Bits::PopCount64(rows[LHS] ^ rows[RHS]) == 1;
-		}
-
-		// Check for a Vertical Line
-		bool CheckCols(uint32_t LHS, uint32_t RHS) const
-		{
-			assert(LHS < width && RHS < width);
-			return cols[LHS] == cols[RHS];
-		}
-
-		bool CanSmudgeCol(uint32_t LHS, uint32_t RHS) const
-		{
-			return Bits::PopCount64(cols[LHS] ^ cols[RHS]) == 1;
-		}
-
-		uint32_t width;
-		uint32_t height;
-		std::vector<char> map;
-		std::vector<uint64_t> rows;
-		std::vector<uint64_t> cols;
-	};
-
-
-	EReflectionType FindReflectionIndex(const Map& map, uint32_t& outIndex, uint32_t& outDistance, bool fixSmudge = false) const
-	{
-		outIndex = 0;
-		outDistance = 0;
-		bool hasSmudge = fixSmudge;
-
-		// Horizontal Line check
-		for (uint32_t i = 0; i < map.height -1; ++i )
-		{
-			hasSmudge = fixSmudge;
-
-			bool valid = map.CheckRows(i, i + 1);
-			if (!valid && hasSmudge)
-			{
-				valid = map.CanSmudgeRows(i, i + 1);
-				hasSmudge = false;
-			}
-
-			if (valid)
-			{
-				uint32_t maxDistance = std::min(i, map.height - 1 - (i + 1));
-				for (size_t j = 0; j < maxDistance; ++j)
-				{
-					valid &= map.CheckRows(i - 1 - j, (i + 1) + 1 + j);
-					if (!valid && hasSmudge)
-					{
-						valid = map.CanSmudgeRows(i - 1 - j, (i + 1) + 1 + j);
-						hasSmudge = false;
-					}
-				}
-
-				if (fixSmudge && hasSmudge)
-				{
-					valid = false;
-				}
-
-				if (valid)
-				{
-					outIndex = i;
-					outDistance = i + 1;
-					return EReflectionType::Horizontal;
-				}
-			}
-		}
-
-		// Vertical Line Check
-		for (uint32_t i = 0; i < map.width - 1; ++i)
-		{
-			hasSmudge = fixSmudge;
-
-			bool valid = map.CheckCols(i, i + 1);
-			if (!valid && hasSmudge)
-			{
-				valid = map.CanSmudgeCol(i, i + 1);
-				hasSmudge = false;
-			}
-
-			if (valid)
-			{
-				uint32_t maxDistance = std::min(i, map.width - 1 -  (i + 1));
-				for (size_t j = 0; j < maxDistance; ++j)
-				{
-					valid &= map.CheckCols(i - 1 - j, (i + 1 ) + 1 + j);
-					if (!valid && hasSmudge)
-					{
-						valid = map.CanSmudgeCol(i - 1 - j, (i + 1) + 1 + j);
-						hasSmudge = false;
-					}
-				}
-
-				if (fixSmudge && hasSmudge)
-				{
-					valid = false;
-				}
-
-				if (valid)
-				{
-					outIndex = i;
-					outDistance = i + 1;
-					return EReflectionType::Vertical;
-				}
-			}
-		}
-
-		return EReflectionType::None;
-	}
-
-	std::vector<Map> m_Maps; 
-	std::vector<uint32_t> m_PartOneHistory;
+	ReflectionBatch m_Batch;
+	std::vector<uint32_t> m_CleanScores;
+	std::vector<uint32_t> m_SmudgedScores;
 };
 
 int main()
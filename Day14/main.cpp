@@ -4,59 +4,92 @@
 #include "AdventGUI/AdventGUI.h"
 
 #include "ACUtils/Bit.h"
+#include "ACUtils/Cycle.h"
 #include "ACUtils/Hash.h"
 #include "ACUtils/Math.h"
 #include "ACUtils/StringUtil.h"
+#include <algorithm>
+#include <string>
 #include <vector>
-#include <unordered_set>
 #include <cinttypes>
 
-class AdventDay : public AdventGUIInstance
+// Any size grid of bits, one row after another. Rows are padded out to whole words and the row count is padded out to a
+// multiple of 64 so the board can be transposed in 64 x 64 blocks. Padding is always zero.
+struct BitBoard
 {
-public:
-	AdventDay(const AdventGUIParams& params) 
-	: AdventGUIInstance(params), m_MapWidth(0)
-	{};
-private:
-	virtual void ParseInput(FileStreamReader& fileReader) override
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t wordsPerRow = 0;
+	std::vector<uint64_t> words;
+
+	void Resize(uint32_t _width, uint32_t _height)
 	{
-		// Parse Input. Input never changes between parts of a problem.
-		std::string line;
-		Bitfield128 dishes;
-		Bitfield128 rocks;
-		Bitfield128 rockMask;
-		while (!fileReader.IsEOF())
+		width = _width;
+		height = _height;
+		wordsPerRow = (width + 63) / 64;
+		words.assign((size_t)GetPaddedHeight() * wordsPerRow, 0);
+	}
+
+	uint32_t GetPaddedHeight() const { return ((height + 63) / 64) * 64; }
+	size_t GetBitOffset(uint32_t x, uint32_t y) const { return ((size_t)y * wordsPerRow * 64) + x; }
+
+	bool IsBitSet(uint32_t x, uint32_t y) const
+	{
+		const size_t offset = GetBitOffset(x, y);
+		return (words[offset / 64] >> (offset % 64)) & 1;
+	}
+
+	void SetBit(uint32_t x, uint32_t y)
+	{
+		const size_t offset = GetBitOffset(x, y);
+		words[offset / 64] |= 1ULL << (offset % 64);
+	}
+
+	uint32_t CountRow(uint32_t y) const
+	{
+		uint32_t count = 0;
+		for (uint32_t word = 0; word < wordsPerRow; ++word)
 		{
-			line = fileReader.ReadLine();
-			if (m_MapWidth == 0)
-			{
-				m_MapWidth = (uint32_t)line.size();
-				rockMask = Bits::CreateBitMask128(m_MapWidth, 128 - m_MapWidth);
-			}
-			assert(m_MapWidth == line.size());
+			count += Bits::PopCount64(words[(size_t)y * wordsPerRow + word]);
+		}
+		return count;
+	}
 
-			dishes &= ~dishes;
-			rocks &= ~rocks;
+	bool operator==(const BitBoard& RHS) const { return width == RHS.width && height == RHS.height && words == RHS.words; }
 
-			for (size_t i = 0; i < line.size(); ++i)
+	// outTransposed's row x is our column x.
+	void Transpose(BitBoard& outTransposed) const
+	{
+		outTransposed.Resize(height, width);
+
+		uint64_t block[64];
+		const uint32_t blockRows = GetPaddedHeight() / 64;
+		for (uint32_t blockY = 0; blockY < blockRows; ++blockY)
+		{
+			for (uint32_t blockX = 0; blockX < wordsPerRow; ++blockX)
 			{
-				if (line[i] == 'O')
+				for (uint32_t i = 0; i < 64; ++i)
 				{
-					dishes.SetBit((uint32_t)i);
+					block[i] = words[((size_t)blockY * 64 + i) * wordsPerRow + blockX];
 				}
-				else if (line[i] == '#')
+
+				Bits::Transpose64x64(block);
+
+				for (uint32_t i = 0; i < 64; ++i)
 				{
-					rocks.SetBit((uint32_t)i);
+					outTransposed.words[((size_t)blockX * 64 + i) * outTransposed.wordsPerRow + blockY] = block[i];
 				}
 			}
-
-			m_Dishes.push_back(dishes);
-			
-			// Add rocks past our width to make for an easy mask.
-			m_Rocks.push_back(rocks | rockMask);
 		}
 	}
+};
 
+// Rolls the dishes in any of the four directions. Rocks never move, so every line splits into the same runs of open cells
+// every time, and a tilt only has to count the dishes in each run and pack that many bits against the low or high end.
+// North / South are done as West / East on a transposed copy, that way every run lies along a row.
+class TiltEngine
+{
+public:
 	enum class Direction : uint8_t
 	{
 		North,
@@ -65,115 +98,209 @@ private:
 		West
 	};
 
-	static void Tilt(const std::vector<Bitfield128>& currentDishes, const std::vector<Bitfield128>& rocks, Direction dir,  uint32_t mapWidth, std::vector<Bitfield128>& outTilted)
+	void Initialize(const BitBoard& rocks)
 	{
-		outTilted.clear();
-		outTilted.reserve(currentDishes.size());
-		outTilted.insert(outTilted.begin(), currentDishes.begin(), currentDishes.end());
+		BitBoard transposedRocks;
+		rocks.Transpose(transposedRocks);
+		BuildRuns(rocks, m_RowRuns);
+		BuildRuns(transposedRocks, m_ColumnRuns);
+	}
 
-		Bitfield128 shiftedBits;
+	void Tilt(const BitBoard& dishes, Direction dir, BitBoard& outTilted)
+	{
 		switch (dir)
 		{
 			case Direction::North:
-			{
-				for (uint32_t i = 1; i < currentDishes.size(); ++i)
-				{
-					for (uint32_t j = i; j != 0; --j)
-					{
-						// Shift up as far as possible
-						shiftedBits = (outTilted[j] ^ outTilted[j - 1]) & ~rocks[j - 1];
-						outTilted[j] &= ~shiftedBits;
-						outTilted[j - 1] |= shiftedBits;
-					}
-				}
-			}
+			case Direction::South:
+				dishes.Transpose(m_Transposed);
+				PackRuns(m_Transposed, m_ColumnRuns, dir == Direction::South, m_TransposedTilted);
+				m_TransposedTilted.Transpose(outTilted);
 			break;
 			case Direction::West:
+			case Direction::East:
+				PackRuns(dishes, m_RowRuns, dir == Direction::East, outTilted);
+			break;
+			default:
+			break;
+		}
+	}
+
+	// North, West, South, East. Each vertical tilt goes straight from its transposed copy into the next horizontal one,
+	// so a spin is four packs and four transposes.
+	void SpinCycle(BitBoard& inOutDishes)
+	{
+		inOutDishes.Transpose(m_Transposed);
+		PackRuns(m_Transposed, m_ColumnRuns, false, m_TransposedTilted);
+		m_TransposedTilted.Transpose(inOutDishes);
+		PackRuns(inOutDishes, m_RowRuns, false, m_Scratch);
+
+		m_Scratch.Transpose(m_Transposed);
+		PackRuns(m_Transposed, m_ColumnRuns, true, m_TransposedTilted);
+		m_TransposedTilted.Transpose(m_Scratch);
+		PackRuns(m_Scratch, m_RowRuns, true, inOutDishes);
+	}
+
+private:
+	// Open cells between rocks. A run that crosses a word boundary is split into pieces, one per word, but most runs are
+	// a single piece so a pack is one popcount and one OR.
+	struct RunPiece
+	{
+		uint32_t word; // Index into the board's words.
+		uint32_t shift;
+		uint32_t length;
+		uint64_t mask;
+	};
+
+	struct Run
+	{
+		uint32_t firstPiece;
+		uint32_t pieceCount;
+	};
+
+	struct RunList
+	{
+		std::vector<Run> runs;
+		std::vector<RunPiece> pieces;
+	};
+
+	static void BuildRuns(const BitBoard& rocks, RunList& outRuns)
+	{
+		outRuns.runs.clear();
+		outRuns.pieces.clear();
+		for (uint32_t y = 0; y < rocks.height; ++y)
+		{
+			uint32_t x = 0;
+			while (x < rocks.width)
 			{
-				// MSB = West
-				uint32_t segmentStart = 0;
-				uint32_t segmentSize = 127;
-				Bitfield128 rockIter;
-				for (uint32_t i = 0; i < currentDishes.size(); ++i)
+				while (x < rocks.width && rocks.IsBitSet(x, y))
 				{
-					shiftedBits = currentDishes[i];
-					rockIter = ~rocks[i];
+					++x;
+				}
 
-					while (!rockIter.IsZero())
+				Run run = { (uint32_t)outRuns.pieces.size(), 0 };
+				while (x < rocks.width && !rocks.IsBitSet(x, y))
+				{
+					const uint32_t pieceStart = x;
+					do
 					{
-						Bits::GetContiguousBitsLSB128(rockIter, segmentStart, segmentSize);
-						if (segmentStart >= mapWidth)
-						{
-							break; // Done.
-						}
-
-						Bitfield128 moveMask = Bits::CreateBitMask128(segmentStart, segmentSize);
-						Bitfield128 toggledBits = shiftedBits & moveMask;
-						uint32_t totalBits = Bits::PopCount128(toggledBits);
-						shiftedBits &= ~toggledBits;
-						shiftedBits |= Bits::CreateBitMask128(segmentStart, totalBits);
-						rockIter.ClearBit(segmentStart);
-					}
-
-					outTilted[i] = shiftedBits;
+						++x;
+					} while (x < rocks.width && x % 64 != 0 && !rocks.IsBitSet(x, y));
+
+					const size_t offset = rocks.GetBitOffset(pieceStart, y);
+					RunPiece piece;
+					piece.word = (uint32_t)(offset / 64);
+					piece.shift = (uint32_t)(offset % 64);
+					piece.length = x - pieceStart;
+					piece.mask = Bits::CreateBitMask64(piece.shift, piece.length);
+					outRuns.pieces.push_back(piece);
+					++run.pieceCount;
+				}
+
+				if (run.pieceCount != 0)
+				{
+					outRuns.runs.push_back(run);
 				}
-			
 			}
-			break;
-			case Direction::South:
+		}
+	}
+
+	// Low = West (or North when transposed), high = East (or South).
+	static void PackRuns(const BitBoard& dishes, const RunList& runList, bool towardHigh, BitBoard& outPacked)
+	{
+		outPacked.Resize(dishes.width, dishes.height);
+		const uint64_t* inWords = dishes.words.data();
+		uint64_t* outWords = outPacked.words.data();
+		for (const Run& run : runList.runs)
+		{
+			const RunPiece* pieces = &runList.pieces[run.firstPiece];
+			if (run.pieceCount == 1)
 			{
-				for (uint32_t i = (uint32_t)currentDishes.size() - 1; i != ~0U ; --i)
+				// An empty run would ask for a mask shifted by 64 when packing high.
+				const uint32_t count = Bits::PopCount64(inWords[pieces->word] & pieces->mask);
+				if (count == 0)
 				{
-					for (uint32_t j = i; j < currentDishes.size() - 1; ++j)
-					{
-						// Shift up as far as possible
-						shiftedBits = (outTilted[j] ^ outTilted[j + 1]) & ~rocks[j + 1];
-						outTilted[j] &= ~shiftedBits;
-						outTilted[j + 1] |= shiftedBits;
-					}
+					continue;
 				}
+				outWords[pieces->word] |= Bits::CreateBitMask64(towardHigh ? pieces->shift + pieces->length - count : pieces->shift, count);
+				continue;
 			}
-			break;
-			case Direction::East:
+
+			uint32_t count = 0;
+			for (uint32_t i = 0; i < run.pieceCount; ++i)
 			{
-				uint32_t segmentStart = 0;
-				uint32_t segmentSize = 0;
-				Bitfield128 rockIter;
-				for (uint32_t i = 0; i < currentDishes.size(); ++i)
-				{
-					shiftedBits = currentDishes[i];
-					rockIter = ~rocks[i];
+				count += Bits::PopCount64(inWords[pieces[i].word] & pieces[i].mask);
+			}
 
-					while (!rockIter.IsZero())
-					{
-						Bits::GetContiguousBitsLSB128(rockIter, segmentStart, segmentSize);
-						if (segmentStart >= mapWidth)
-						{
-							break; // Done.
-						}
-
-						Bitfield128 moveMask = Bits::CreateBitMask128(segmentStart, segmentSize);
-						Bitfield128 toggledBits = shiftedBits & moveMask;
-						uint32_t totalBits = Bits::PopCount128(toggledBits);
-						shiftedBits &= ~toggledBits;
-						shiftedBits |= Bits::CreateBitMask128( segmentStart + segmentSize - totalBits, totalBits);
-						rockIter.ClearBit(segmentStart);
-					}
-
-					outTilted[i] = shiftedBits; 
+			// Fill whole pieces from the packed end until the count runs out.
+			for (uint32_t i = 0; i < run.pieceCount && count != 0; ++i)
+			{
+				const RunPiece& piece = pieces[towardHigh ? run.pieceCount - 1 - i : i];
+				const uint32_t filled = std::min(count, piece.length);
+				outWords[piece.word] |= Bits::CreateBitMask64(towardHigh ? piece.shift + piece.length - filled : piece.shift, filled);
+				count -= filled;
+			}
+		}
+	}
+
+	RunList m_RowRuns;
+	RunList m_ColumnRuns;
+
+	// Scratch, kept around so spins don't allocate.
+	BitBoard m_Transposed;
+	BitBoard m_TransposedTilted;
+	BitBoard m_Scratch;
+};
+
+class AdventDay : public AdventGUIInstance
+{
+public:
+	AdventDay(const AdventGUIParams& params) 
+	: AdventGUIInstance(params)
+	{};
+private:
+	virtual void ParseInput(FileStreamReader& fileReader) override
+	{
+		// Parse Input. Input never changes between parts of a problem.
+		std::vector<std::string> lines;
+		while (!fileReader.IsEOF())
+		{
+			std::string line = fileReader.ReadLine();
+			if (!line.empty())
+			{
+				assert(lines.empty() || lines[0].size() == line.size());
+				lines.push_back(line);
+			}
+		}
+		assert(!lines.empty());
+
+		const uint32_t mapWidth = (uint32_t)lines[0].size();
+		const uint32_t mapHeight = (uint32_t)lines.size();
+		m_Dishes.Resize(mapWidth, mapHeight);
+		m_Rocks.Resize(mapWidth, mapHeight);
+		for (uint32_t y = 0; y < mapHeight; ++y)
+		{
+			for (uint32_t x = 0; x < mapWidth; ++x)
+			{
+				if (lines[y][x] == 'O')
+				{
+					m_Dishes.SetBit(x, y);
+				}
+				else if (lines[y][x] == '#')
+				{
+					m_Rocks.SetBit(x, y);
 				}
 			}
-			default:
-			break;
 		}
+
+		m_Engine.Initialize(m_Rocks);
 	}
 
-	static uint32_t ScoreDishes(const std::vector<Bitfield128>& dishes)
+	static uint32_t ScoreDishes(const BitBoard& dishes)
 	{
 		uint32_t returnValue = 0;
-		for (uint32_t i = 0; i < (uint32_t)dishes.size(); ++i)
+		for (uint32_t y = 0; y < dishes.height; ++y)
 		{
-			returnValue += ((uint32_t)dishes.size() - i) * Bits::PopCount128(dishes[i]);
+			returnValue += (dishes.height - y) * dishes.CountRow(y);
 		}
 
 		return returnValue;
@@ -182,8 +309,8 @@ private:
 	virtual void PartOne(const AdventGUIContext& context) override
 	{
 		// Part One
-		std::vector<Bitfield128> shiftedRocks;
-		Tilt(m_Dishes, m_Rocks, Direction::North, m_MapWidth, shiftedRocks);
+		BitBoard shiftedRocks;
+		m_Engine.Tilt(m_Dishes, TiltEngine::Direction::North, shiftedRocks);
 
 		uint32_t totalScore = ScoreDishes(shiftedRocks);
 
@@ -193,164 +320,70 @@ private:
 		AdventGUIInstance::PartOne(context);
 	}
 
-	void PrintMap(const std::vector<Bitfield128>& dishes, const std::vector<Bitfield128>& rocks) const
+	void PrintMap(const BitBoard& dishes) const
 	{
-		char printBuffer[2048] = { 0 };
-		char lineBuffer[128] = { 0 };
-		Bitfield128 currentBitfield;
-		for (uint32_t i = 0; i < (uint32_t)dishes.size(); ++i)
+		std::string printBuffer;
+		printBuffer.reserve((size_t)(dishes.width + 1) * dishes.height);
+		for (uint32_t y = 0; y < dishes.height; ++y)
 		{
-			currentBitfield = dishes[i] | rocks[i];
-			for (uint32_t j = 0; j < m_MapWidth; ++j)
+			for (uint32_t x = 0; x < dishes.width; ++x)
 			{
-				if (currentBitfield.IsBitSet(j))
+				if (dishes.IsBitSet(x, y))
 				{
-					lineBuffer[j] = dishes[i].IsBitSet(j) ? 'O' : '#';
+					printBuffer.push_back('O');
 				}
 				else
 				{
-					lineBuffer[j] = '.';
+					printBuffer.push_back(m_Rocks.IsBitSet(x, y) ? '#' : '.');
 				}
 			}
 
-			lineBuffer[m_MapWidth] = '\n';
-
-			memcpy(printBuffer + i * (m_MapWidth + 1), lineBuffer, m_MapWidth + 1);
+			printBuffer.push_back('\n');
 		}
 
-		printBuffer[(uint32_t)dishes.size() * (m_MapWidth + 1)] = '\0';
-
-		Log("\n%s", printBuffer);
+		Log("\n%s", printBuffer.c_str());
 	}
 
-	struct CycleRecord
-	{
-		CycleRecord()
-		{
-		}
-
-		CycleRecord(const std::vector<Bitfield128>& _record)
-		: record(_record)
-		{
-			hash = 0;
-			uint32_t primeIndex = 1;
-			for (const Bitfield128& bits : record)
-			{
-				hash = Hash::HashCombineU64(hash, bits.GetLow());
-				hash = Hash::HashCombineU64(hash, bits.GetHigh());
-			}
-		};
-
-		std::vector<Bitfield128> record;
-		uint64_t hash;
-
-		bool operator==(const CycleRecord& RHS) const
-		{
-			if (record.size() == RHS.record.size())
-			{
-				for (size_t i = 0; i < record.size(); ++i)
-				{
-					if (record[i] != RHS.record[i])
-					{
-						return false;
-					}
-				}
-
-				return true;
-			}
-
-			return false;
-		}
-
-		bool operator!=(const CycleRecord& RHS) const
-		{
-			if (record.size() != RHS.record.size())
-			{
-				return true;
-			}
-			else
-			{
-				for (size_t i = 0; i < record.size(); ++i)
-				{
-					if (record[i] != RHS.record[i])
-					{
-						return true;
-					}
-				}
-			}
-
-			return false;
-		}
-	};
-
-	class CycleRecordHasher
+	static uint64_t HashDishes(const BitBoard& dishes)
 	{
-	public:
-		std::size_t operator()(const CycleRecord& LHS) const
+		uint64_t hash = 0;
+		for (uint64_t word : dishes.words)
 		{
-			return LHS.hash;
+			hash = Hash::HashCombineU64(hash, word);
 		}
-	};
+		return hash;
+	}
 
 	virtual void PartTwo(const AdventGUIContext& context) override
 	{	
 		// Part Two
-		std::vector<CycleRecord> allRecords;
-		std::unordered_set<CycleRecord, CycleRecordHasher> uniqueRecords;
-
-		Direction dirs[] = { Direction::North, Direction::West, Direction::South, Direction::East };
-
-		std::vector<Bitfield128> pingPong[2] = { m_Dishes, m_Dishes };
-		uint32_t pingPongIndex = 0;
+		constexpr uint64_t totalIters = 1000000000;
 
-		allRecords.reserve(1024);
-		allRecords.emplace_back(m_Dishes);
-		uniqueRecords.insert(allRecords.back());
+		auto spin = [this](BitBoard& dishes) { m_Engine.SpinCycle(dishes); };
 
-		constexpr size_t totalIters = 1000000000;
-
-		for (size_t i = 0; i < totalIters; ++i)
+		// The dishes settle into a loop pretty quickly, so only the first mu + lambda spins need simulating.
+		BitBoard dishes = m_Dishes;
+		Cycle::Result cycle;
+		if (!Cycle::FindWithFingerprints(dishes, spin, HashDishes, cycle, totalIters))
 		{
-			for (Direction dir : dirs)
-			{
-				Tilt(pingPong[pingPongIndex], m_Rocks, dir, m_MapWidth, pingPong[pingPongIndex ^ 1]);
-				pingPongIndex ^= 1;
-			}
-
-			CycleRecord newRecord(pingPong[pingPongIndex]);
-
-			// Looping?
-			std::unordered_set<CycleRecord, CycleRecordHasher>::iterator itFind = uniqueRecords.find(newRecord);
-			if ( itFind == uniqueRecords.end())
-			{
-				uniqueRecords.insert(newRecord);
-			}
-			else
-			{
-				assert(*itFind == newRecord);
-				size_t lastSeen = std::find(allRecords.begin(), allRecords.end(), newRecord) - allRecords.begin();
-				size_t cycleLength = allRecords.size() - lastSeen;
-				Log("Found loop on iteration %zd, length is %zd", i, cycleLength);
-				i = totalIters - (totalIters - i) % cycleLength;
-				break;
-			}
-
-			allRecords.push_back(newRecord);
+			Log("Dishes never settled into a loop, giving up.");
+			AdventGUIInstance::PartTwo(context);
+			return;
 		}
+		Log("Found loop on iteration %" PRIu64 ", length is %" PRIu64, cycle.mu + cycle.lambda, cycle.lambda);
 
-		uint32_t totalScore = ScoreDishes(allRecords.back().record);
+		Cycle::AdvanceFromLoopStart(dishes, spin, cycle, totalIters);
+		uint32_t totalScore = ScoreDishes(dishes);
 
 		Log("Total Score after spin cycle: %u", totalScore);
 
 		// Done.
 		AdventGUIInstance::PartTwo(context);
-
-
 	}
 
-	std::vector<Bitfield128> m_Dishes;
-	std::vector<Bitfield128> m_Rocks;
-	uint32_t m_MapWidth;
+	BitBoard m_Dishes;
+	BitBoard m_Rocks;
+	TiltEngine m_Engine;
 };
 
 int main()
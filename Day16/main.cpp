@@ -3,19 +3,500 @@
 
 #include "AdventGUI/AdventGUI.h"
 
+#include "ACUtils/Bit.h"
 #include "ACUtils/IntVec.h"
+#include "ACUtils/Parallel.h"
 #include "ACUtils/Vec.h"
 #include "ACUtils/StringUtil.h"
 #include <unordered_set>
 #include <vector>
 #include <cinttypes>
+#include <memory>
+
+// Beam propagation over the cave.
+// Visited (tile, direction) pairs are stored as a 4 bit mask per tile (16 tiles per uint64_t). Beams jump straight from one
+// mirror / splitter to the next using a precomputed table, and a walk ends exactly when its work stack runs dry.
+class BeamEngine
+{
+public:
+	enum BeamDir : uint32_t
+	{
+		East = 0,
+		South,
+		West,
+		North
+	};
+
+	static constexpr uint32_t INVALID_TILE = ~0U;
+
+	BeamEngine(const std::vector<char>& map, uint32_t mapWidth, uint32_t mapHeight)
+	: m_map(map),
+	m_mapWidth(mapWidth),
+	m_mapHeight(mapHeight)
+	{
+		BuildJumpTable();
+	}
+
+	uint32_t GetTileCount() const { return m_mapWidth * m_mapHeight; }
+	uint32_t GetTileIndex(uint32_t x, uint32_t y) const { return y * m_mapWidth + x; }
+
+	static uint32_t GetDirFromVelocity(const IntVec2& vel)
+	{
+		if (vel.x != 0)
+		{
+			return vel.x > 0 ? East : West;
+		}
+
+		return vel.y > 0 ? South : North;
+	}
+
+	// Visited bit helpers, usable by anyone holding a visited array sized with GetVisitedWordCount.
+	size_t GetVisitedWordCount() const { return (GetTileCount() + 15) / 16; }
+
+	static bool IsVisited(const std::vector<uint64_t>& visited, uint32_t tile, uint32_t dir)
+	{
+		return (visited[tile / 16] >> ((tile % 16) * 4 + dir) & 1ULL) != 0;
+	}
+
+	static void MarkVisited(std::vector<uint64_t>& visited, uint32_t tile, uint32_t dir)
+	{
+		visited[tile / 16] |= 1ULL << ((tile % 16) * 4 + dir);
+	}
+
+	// Any direction bit set in a nibble counts as an energized tile.
+	static size_t CountEnergized(const std::vector<uint64_t>& visited)
+	{
+		size_t total = 0;
+		for (uint64_t word : visited)
+		{
+			word |= word >> 1;
+			word |= word >> 2;
+			total += Bits::PopCount64(word & 0x1111111111111111ULL);
+		}
+		return total;
+	}
+
+	// Fires a beam into entryTile heading in dir, fills out visited and returns how many tiles were energized.
+	// visited / stack are caller owned scratch so workers can reuse them between tests.
+	size_t Energize(uint32_t entryTile, uint32_t dir, std::vector<uint64_t>& visited, std::vector<uint64_t>& stack) const
+	{
+		visited.assign(GetVisitedWordCount(), 0);
+		stack.clear();
+		stack.push_back(PackBeam(entryTile, dir));
+
+		uint32_t outDirs[2];
+		while (!stack.empty())
+		{
+			const uint64_t beam = stack.back();
+			stack.pop_back();
+
+			const uint32_t tile = (uint32_t)(beam >> 2);
+			const uint32_t inDir = (uint32_t)(beam & 3);
+
+			// Loops can only close on an optic, so that's the only place we need to check.
+			if (IsVisited(visited, tile, inDir))
+			{
+				continue;
+			}
+			MarkVisited(visited, tile, inDir);
+
+			const uint32_t outCount = GetOutDirs(m_map[tile], inDir, outDirs);
+			for (uint32_t i = 0; i < outCount; ++i)
+			{
+				const uint32_t nextTile = FollowRun(tile, outDirs[i], visited);
+				if (nextTile != INVALID_TILE)
+				{
+					stack.push_back(PackBeam(nextTile, outDirs[i]));
+				}
+			}
+		}
+
+		return CountEnergized(visited);
+	}
+
+	// Given the tile a beam is entering and the direction it's heading, fills outDirs with the direction(s) it leaves in.
+	static uint32_t GetOutDirs(char tile, uint32_t inDir, uint32_t outDirs[2])
+	{
+		switch (tile)
+		{
+		case '|':
+			if (inDir == East || inDir == West)
+			{
+				outDirs[0] = North;
+				outDirs[1] = South;
+				return 2;
+			}
+			break;
+		case '-':
+			if (inDir == North || inDir == South)
+			{
+				outDirs[0] = East;
+				outDirs[1] = West;
+				return 2;
+			}
+			break;
+		case '/':
+			outDirs[0] = 3 - inDir; // E <-> N, S <-> W
+			return 1;
+		case '\\':
+			outDirs[0] = inDir ^ 1; // E <-> S, W <-> N
+			return 1;
+		default:
+			break;
+		}
+
+		outDirs[0] = inDir;
+		return 1;
+	}
+
+	struct Jump
+	{
+		uint32_t target; // Next tile that will redirect a beam heading this way, or INVALID_TILE if we run off the map.
+		uint32_t steps;	 // Number of tiles strictly between us and target (or the map edge).
+	};
+
+	const Jump& GetJump(uint32_t tile, uint32_t dir) const { return m_jumps[tile * 4 + dir]; }
+
+	static bool RedirectsBeam(char tile, uint32_t dir)
+	{
+		switch (tile)
+		{
+		case '/':
+		case '\\': return true;
+		case '|': return dir == East || dir == West;
+		case '-': return dir == North || dir == South;
+		default: return false;
+		}
+	}
+
+	int32_t GetTileStride(uint32_t dir) const
+	{
+		switch (dir)
+		{
+		case East: return 1;
+		case South: return (int32_t)m_mapWidth;
+		case West: return -1;
+		case North:
+		default: return -(int32_t)m_mapWidth;
+		}
+	}
+
+private:
+	static uint64_t PackBeam(uint32_t tile, uint32_t dir) { return ((uint64_t)tile << 2) | dir; }
+
+	// Energizes every tile strictly between tile and the next optic, and returns that optic (or INVALID_TILE if we leave the map).
+	uint32_t FollowRun(uint32_t tile, uint32_t dir, std::vector<uint64_t>& visited) const
+	{
+		const Jump& jump = m_jumps[tile * 4 + dir];
+		const int32_t stride = GetTileStride(dir);
+		int32_t current = (int32_t)tile;
+		for (uint32_t i = 0; i < jump.steps; ++i)
+		{
+			current += stride;
+			MarkVisited(visited, (uint32_t)current, dir);
+		}
+
+		return jump.target;
+	}
+
+	void BuildJumpTable()
+	{
+		m_jumps.resize((size_t)GetTileCount() * 4);
+
+		// Sweep each row / column against the direction of travel so every tile can inherit from its neighbor.
+		for (uint32_t y = 0; y < m_mapHeight; ++y)
+		{
+			BuildJumpLine(East, GetTileIndex(m_mapWidth - 1, y), -1, m_mapWidth);
+			BuildJumpLine(West, GetTileIndex(0, y), 1, m_mapWidth);
+		}
+
+		for (uint32_t x = 0; x < m_mapWidth; ++x)
+		{
+			BuildJumpLine(South, GetTileIndex(x, m_mapHeight - 1), -(int32_t)m_mapWidth, m_mapHeight);
+			BuildJumpLine(North, GetTileIndex(x, 0), (int32_t)m_mapWidth, m_mapHeight);
+		}
+	}
+
+	// firstTile is the last tile a beam heading in dir would touch, stride walks back towards where it came from.
+	void BuildJumpLine(uint32_t dir, uint32_t firstTile, int32_t stride, uint32_t length)
+	{
+		Jump next = { INVALID_TILE, 0 };
+		int32_t tile = (int32_t)firstTile;
+		for (uint32_t i = 0; i < length; ++i, tile += stride)
+		{
+			m_jumps[tile * 4 + dir] = next;
+			if (RedirectsBeam(m_map[tile], dir))
+			{
+				next.target = (uint32_t)tile;
+				next.steps = 0;
+			}
+			else
+			{
+				++next.steps;
+			}
+		}
+	}
+
+	const std::vector<char>& m_map;
+	uint32_t m_mapWidth;
+	uint32_t m_mapHeight;
+	std::vector<Jump> m_jumps;
+};
+
+// Condensed beam graph so part two doesn't have to re-walk the cave for every entry point.
+// Nodes are (optic, exit direction) pairs, edges are the straight runs between optics, and each node covers the tiles of its
+// outgoing run. Tarjan's SCC pass finishes components in reverse topological order, so a component's reachable coverage is
+// just its own runs OR'd with the (already finished) coverage of every component it leads into.
+class SplitterGraph
+{
+public:
+	SplitterGraph(const BeamEngine& engine, const std::vector<char>& map)
+	: m_engine(engine),
+	m_map(map),
+	m_wordsPerSet((engine.GetTileCount() + 63) / 64),
+	m_componentCount(0)
+	{
+		BuildNodes();
+		Condense();
+	}
+
+	size_t GetWordsPerSet() const { return m_wordsPerSet; }
+	uint32_t GetNodeCount() const { return (uint32_t)m_nodeComponent.size(); }
+	uint32_t GetComponentCount() const { return m_componentCount; }
+
+	// Energized tile count for a beam entering entryTile heading dir. scratch is a caller owned tile bitset.
+	size_t Energize(uint32_t entryTile, uint32_t dir, std::vector<uint64_t>& scratch) const
+	{
+		scratch.assign(m_wordsPerSet, 0);
+		uint64_t* tileBits = scratch.data();
+		SetTile(tileBits, entryTile);
+
+		uint32_t arrivalTile = entryTile;
+		if (!BeamEngine::RedirectsBeam(m_map[entryTile], dir))
+		{
+			arrivalTile = MarkRun(entryTile, dir, tileBits);
+		}
+
+		if (arrivalTile != BeamEngine::INVALID_TILE)
+		{
+			uint32_t outDirs[2];
+			const uint32_t outCount = BeamEngine::GetOutDirs(m_map[arrivalTile], dir, outDirs);
+			for (uint32_t i = 0; i < outCount; ++i)
+			{
+				OrInto(tileBits, GetComponentReach(m_nodeComponent[GetNode(arrivalTile, outDirs[i])]));
+			}
+		}
+
+		size_t total = 0;
+		for (size_t i = 0; i < m_wordsPerSet; ++i)
+		{
+			total += Bits::PopCount64(tileBits[i]);
+		}
+		return total;
+	}
+
+private:
+	static constexpr uint32_t INVALID_NODE = ~0U;
+
+	uint32_t GetNode(uint32_t tile, uint32_t exitDir) const { return m_opticIndex[tile] * 4 + exitDir; }
+	uint32_t GetNodeTile(uint32_t node) const { return m_opticTiles[node / 4]; }
+	uint32_t GetNodeDir(uint32_t node) const { return node % 4; }
+
+	static void SetTile(uint64_t* tileBits, uint32_t tile) { tileBits[tile / 64] |= 1ULL << (tile % 64); }
+
+	void OrInto(uint64_t* dest, const uint64_t* source) const
+	{
+		for (size_t i = 0; i < m_wordsPerSet; ++i)
+		{
+			dest[i] |= source[i];
+		}
+	}
+
+	uint64_t* GetComponentReach(uint32_t component) { return m_componentReach.data() + component * m_wordsPerSet; }
+	const uint64_t* GetComponentReach(uint32_t component) const { return m_componentReach.data() + component * m_wordsPerSet; }
+
+	// Marks every tile after tile heading in dir up to and including the next optic, returns that optic (or INVALID_TILE).
+	uint32_t MarkRun(uint32_t tile, uint32_t dir, uint64_t* tileBits) const
+	{
+		const BeamEngine::Jump& jump = m_engine.GetJump(tile, dir);
+		const int32_t stride = m_engine.GetTileStride(dir);
+		int32_t current = (int32_t)tile;
+		for (uint32_t i = 0; i < jump.steps; ++i)
+		{
+			current += stride;
+			SetTile(tileBits, (uint32_t)current);
+		}
+
+		if (jump.target != BeamEngine::INVALID_TILE)
+		{
+			SetTile(tileBits, jump.target);
+		}
+
+		return jump.target;
+	}
+
+	void BuildNodes()
+	{
+		m_opticIndex.assign(m_engine.GetTileCount(), INVALID_NODE);
+		for (uint32_t tile = 0; tile < m_engine.GetTileCount(); ++tile)
+		{
+			if (m_map[tile] != '.')
+			{
+				m_opticIndex[tile] = (uint32_t)m_opticTiles.size();
+				m_opticTiles.push_back(tile);
+			}
+		}
+
+		// Each node has at most two successors (the exits of the optic its run lands on).
+		const uint32_t nodeCount = (uint32_t)m_opticTiles.size() * 4;
+		m_successors.assign(nodeCount * 2, INVALID_NODE);
+		uint32_t outDirs[2];
+		for (uint32_t node = 0; node < nodeCount; ++node)
+		{
+			const uint32_t dir = GetNodeDir(node);
+			const uint32_t target = m_engine.GetJump(GetNodeTile(node), dir).target;
+			if (target == BeamEngine::INVALID_TILE)
+			{
+				continue;
+			}
+
+			const uint32_t outCount = BeamEngine::GetOutDirs(m_map[target], dir, outDirs);
+			for (uint32_t i = 0; i < outCount; ++i)
+			{
+				m_successors[node * 2 + i] = GetNode(target, outDirs[i]);
+			}
+		}
+
+		m_nodeComponent.assign(nodeCount, INVALID_NODE);
+	}
+
+	// Iterative Tarjan so large caves can't blow the stack.
+	void Condense()
+	{
+		const uint32_t nodeCount = GetNodeCount();
+		std::vector<uint32_t> index(nodeCount, INVALID_NODE);
+		std::vector<uint32_t> lowLink(nodeCount, 0);
+		std::vector<bool> onStack(nodeCount, false);
+		std::vector<uint32_t> componentStack;
+
+		struct Frame
+		{
+			uint32_t node;
+			uint32_t nextSuccessor;
+		};
+		std::vector<Frame> callStack;
+		uint32_t nextIndex = 0;
+
+		auto visit = [&](uint32_t node)
+		{
+			index[node] = lowLink[node] = nextIndex++;
+			componentStack.push_back(node);
+			onStack[node] = true;
+			callStack.push_back({ node, 0 });
+		};
+
+		for (uint32_t root = 0; root < nodeCount; ++root)
+		{
+			if (index[root] != INVALID_NODE)
+			{
+				continue;
+			}
+
+			visit(root);
+			while (!callStack.empty())
+			{
+				const uint32_t node = callStack.back().node;
+				if (callStack.back().nextSuccessor < 2)
+				{
+					const uint32_t successor = m_successors[node * 2 + callStack.back().nextSuccessor++];
+					if (successor == INVALID_NODE)
+					{
+						continue;
+					}
+
+					if (index[successor] == INVALID_NODE)
+					{
+						visit(successor);
+					}
+					else if (onStack[successor])
+					{
+						lowLink[node] = std::min(lowLink[node], index[successor]);
+					}
+					continue;
+				}
+
+				callStack.pop_back();
+				if (!callStack.empty())
+				{
+					const uint32_t parent = callStack.back().node;
+					lowLink[parent] = std::min(lowLink[parent], lowLink[node]);
+				}
+
+				if (lowLink[node] == index[node])
+				{
+					FinishComponent(node, componentStack, onStack);
+				}
+			}
+		}
+	}
+
+	void FinishComponent(uint32_t rootNode, std::vector<uint32_t>& componentStack, std::vector<bool>& onStack)
+	{
+		const uint32_t component = m_componentCount++;
+		m_componentReach.resize(m_componentCount * m_wordsPerSet, 0);
+
+		// Members sit on top of the stack, down to the root, so this is O(component size).
+		size_t firstMember = componentStack.size();
+		do
+		{
+			--firstMember;
+		} while (componentStack[firstMember] != rootNode);
+		for (size_t i = firstMember; i < componentStack.size(); ++i)
+		{
+			m_nodeComponent[componentStack[i]] = component;
+			onStack[componentStack[i]] = false;
+		}
+
+		uint64_t* reach = GetComponentReach(component);
+		for (size_t i = firstMember; i < componentStack.size(); ++i)
+		{
+			const uint32_t member = componentStack[i];
+			SetTile(reach, GetNodeTile(member));
+			MarkRun(GetNodeTile(member), GetNodeDir(member), reach);
+
+			// Anything we lead into outside of ourselves is already finished.
+			for (uint32_t j = 0; j < 2; ++j)
+			{
+				const uint32_t successor = m_successors[member * 2 + j];
+				if (successor != INVALID_NODE && m_nodeComponent[successor] != component)
+				{
+					OrInto(reach, GetComponentReach(m_nodeComponent[successor]));
+				}
+			}
+		}
+
+		componentStack.resize(firstMember);
+	}
+
+	const BeamEngine& m_engine;
+	const std::vector<char>& m_map;
+	size_t m_wordsPerSet;
+	uint32_t m_componentCount;
+	std::vector<uint32_t> m_opticTiles;		// Dense optic index -> tile
+	std::vector<uint32_t> m_opticIndex;		// Tile -> dense optic index
+	std::vector<uint32_t> m_successors;		// 2 per node
+	std::vector<uint32_t> m_nodeComponent;
+	std::vector<uint64_t> m_componentReach;	// m_wordsPerSet words per component
+};
+
+constexpr uint32_t SplitterGraph::INVALID_NODE;
 
 class AdventDay : public AdventGUIInstance
 {
 public:
 	AdventDay(const AdventGUIParams& params) 
 	: AdventGUIInstance(params),
-	m_lastStableStep(0),
+	m_totalSimSteps(0),
 	m_MapWidth(0),
 	m_MapHeight(0),
 	m_ActiveIndex(0),
@@ -40,11 +521,15 @@ private:
 
 		m_MapHeight = (uint32_t)m_Map.size() / m_MapWidth;
 
+		m_BeamEngine.reset(new BeamEngine(m_Map, m_MapWidth, m_MapHeight));
+		m_SplitterGraph.reset(new SplitterGraph(*m_BeamEngine, m_Map));
+		m_VisitedTiles.assign(m_BeamEngine->GetVisitedWordCount(), 0);
 		m_ActiveLights[0].insert(IntVec4(-1, 0, 1, 0)); // (0,0) going (1,0)
-		//m_TouchedTiles.insert(IntVec2(0, 0));
 	}
 
-	void Simulate(std::unordered_set<IntVec4>& InPosVel, std::unordered_set<IntVec4>& OutPosVel, std::unordered_set<IntVec2>& outTouchedTiles)
+	// Single step of every active beam, only used for visualizing part one. Beams that enter a tile in a direction
+	// we've already seen are dropped, so the active set empties out once the cave is fully lit.
+	void Simulate(std::unordered_set<IntVec4>& InPosVel, std::unordered_set<IntVec4>& OutPosVel, std::vector<uint64_t>& outVisitedTiles)
 	{
 		std::vector<IntVec4> newBeams;
 		OutPosVel.clear();
@@ -64,7 +549,15 @@ private:
 				continue;
 			}
 
-			outTouchedTiles.insert(PosVel.XY());
+			const uint32_t tileIndex = m_BeamEngine->GetTileIndex(PosVel.x, PosVel.y);
+			const uint32_t tileDir = BeamEngine::GetDirFromVelocity(IntVec2(PosVel.z, PosVel.w));
+			if (BeamEngine::IsVisited(outVisitedTiles, tileIndex, tileDir))
+			{
+				// Already been here, heading this way.
+				++itIter;
+				continue;
+			}
+			BeamEngine::MarkVisited(outVisitedTiles, tileIndex, tileDir);
 
 			// Update velocities
 			switch (m_Map[PosVel.y * m_MapWidth + PosVel.x])
@@ -133,7 +626,7 @@ private:
 		}
 	}
 
-	bool DrawCaveState(std::unordered_set<IntVec4>& InOutPosVel, std::unordered_set<IntVec2>& outTouchedTiles)
+	bool DrawCaveState(std::unordered_set<IntVec4>& InOutPosVel, const std::vector<uint64_t>& visitedTiles)
 	{
 		bool shouldStep = false;
 
@@ -199,7 +692,7 @@ private:
 					{
 						tileState = 2;
 					}
-					else if (outTouchedTiles.find(cavePos) != outTouchedTiles.end())
+					else if ((visitedTiles[(y * m_MapWidth + x) / 16] >> (((y * m_MapWidth + x) % 16) * 4) & 0xF) != 0)
 					{
 						tileState = 1;
 					}
@@ -324,7 +817,7 @@ private:
 		ImGui::SameLine();
 		ImGui::BeginChild("Options", ImVec2(192.0f, 128.0f), false, ImGuiWindowFlags_NoSavedSettings);
 		ImGui::Text("Simulation Steps: %u", m_totalSimSteps);
-		ImGui::Text("Energized Tiles: %zd", outTouchedTiles.size());
+		ImGui::Text("Energized Tiles: %zd", BeamEngine::CountEnergized(visitedTiles));
 		ImGui::Checkbox("Auto-Step", &m_AutoStep);
 		ImGui::BeginDisabled(m_AutoStep);
 		if (ImGui::Button("Step"))
@@ -342,35 +835,27 @@ private:
 	virtual void PartOne(const AdventGUIContext& context) override
 	{
 		// Part One
-		size_t previousTouchedTiles = m_TouchedTiles.size();
-		bool forceStep = DrawCaveState(m_ActiveLights[m_ActiveIndex], m_TouchedTiles);
-
+		bool forceStep = DrawCaveState(m_ActiveLights[m_ActiveIndex], m_VisitedTiles);
 
 		if ( forceStep || m_AutoStep )
 		{
-			Simulate(m_ActiveLights[m_ActiveIndex], m_ActiveLights[m_ActiveIndex ^ 1], m_TouchedTiles);
+			Simulate(m_ActiveLights[m_ActiveIndex], m_ActiveLights[m_ActiveIndex ^ 1], m_VisitedTiles);
 			++m_totalSimSteps;
 			m_ActiveIndex ^= 1;
+			Log("Step %u Energized: %zd, Actives: %zd", m_totalSimSteps, BeamEngine::CountEnergized(m_VisitedTiles), m_ActiveLights[m_ActiveIndex].size());
 		}
 
-		if (previousTouchedTiles == m_TouchedTiles.size() )
-		{
-			++m_lastStableStep;
-			Log("Stable Step Count: %zd, Actives: %zd for %u frames.", m_TouchedTiles.size(), m_ActiveLights[m_ActiveIndex].size(), m_lastStableStep);
-			if (m_lastStableStep > 200)
-			{
-				m_AutoStep = false;
-			}
-		}
-		else
+		// No beams left means nothing else can change.
+		if (m_ActiveLights[m_ActiveIndex].empty())
 		{
-			Log("New Step Count: %zd, Actives: %zd", m_TouchedTiles.size(), m_ActiveLights[m_ActiveIndex].size());			
-			m_lastStableStep = 0;
-		}
+			m_AutoStep = false;
 
-		if (m_AutoStep && m_lastStableStep >= 200)
-		{
-			Log("Total touched tiles = %zd", m_TouchedTiles.size());
+			// The stepping is only for show, the jump table walk gets the same answer in one go.
+			std::vector<uint64_t> visited;
+			std::vector<uint64_t> stack;
+			const size_t totalEnergized = m_BeamEngine->Energize(m_BeamEngine->GetTileIndex(0, 0), BeamEngine::East, visited, stack);
+			assert(totalEnergized == BeamEngine::CountEnergized(m_VisitedTiles));
+			Log("Total touched tiles = %zd", totalEnergized);
 
 			// Done.
 			AdventGUIInstance::PartOne(context);
@@ -380,99 +865,57 @@ private:
 	struct TestResults
 	{
 		TestResults() : Pos(0), Dir(0), TotalEnergy(0){};
-		IntVec2 Pos;
+		IntVec2 Pos; // First tile the beam enters.
 		IntVec2 Dir;
 		size_t TotalEnergy;
 	};
 
-	void GetEnergyForTest(TestResults& outResults)
-	{
-		m_ActiveIndex = 0;
-		m_ActiveLights[0].clear();
-		m_ActiveLights[1].clear();
-		m_lastStableStep = 0;
-		m_totalSimSteps = 0;
-		m_TouchedTiles.clear();
-
-		m_ActiveLights[m_ActiveIndex].insert(IntVec4(outResults.Pos.x, outResults.Pos.y, outResults.Dir.x, outResults.Dir.y));
-
-		while (true)
-		{
-			size_t previousTouchedTiles = m_TouchedTiles.size();
-			Simulate(m_ActiveLights[m_ActiveIndex], m_ActiveLights[m_ActiveIndex ^ 1], m_TouchedTiles);
-			++m_totalSimSteps;
-			m_ActiveIndex ^= 1;
-
-			if (previousTouchedTiles == m_TouchedTiles.size())
-			{
-				++m_lastStableStep;
-				//Log("Stable Step Count: %zd, Actives: %zd for %u frames.", m_TouchedTiles.size(), m_ActiveLights[m_ActiveIndex].size(), m_lastStableStep);
-				if (m_lastStableStep > 200)
-				{
-					outResults.TotalEnergy = m_TouchedTiles.size();
-					break;
-				}
-			}
-		}
-	}
-
 	virtual void PartTwo(const AdventGUIContext& context) override
 	{	
 		// Part Two
 		const IntVec2 directions[] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
 		std::vector<TestResults> allTests;
+		allTests.reserve(2 * (m_MapWidth + m_MapHeight));
 
 		// All top/bottom rows, heading down/up.
 		for (uint32_t i = 0; i < m_MapWidth; ++i)
 		{
-			// Up heading down
-			TestResults resultsA;
-			resultsA.Pos = IntVec2(i, -1);
-			resultsA.Dir = directions[1];
-
-			GetEnergyForTest(resultsA);
-
-			Log("Test [%d, %d] with Direction [%d, %d] came back with %zd total energy.", resultsA.Pos.x, resultsA.Pos.y, resultsA.Dir.x, resultsA.Dir.y, resultsA.TotalEnergy);
-
-			allTests.push_back(resultsA);
+			allTests.emplace_back();
+			allTests.back().Pos = IntVec2(i, 0);
+			allTests.back().Dir = directions[1];
 
-			// Down heading up
-			TestResults resultsB;
-			resultsB.Pos = (i, m_MapHeight);
-			resultsB.Dir = directions[3];
-
-			GetEnergyForTest(resultsB);
-
-			Log("Test [%d, %d] with Direction [%d, %d] came back with %zd total energy.", resultsB.Pos.x, resultsB.Pos.y, resultsB.Dir.x, resultsB.Dir.y, resultsB.TotalEnergy);
-
-			allTests.push_back(resultsB);
+			allTests.emplace_back();
+			allTests.back().Pos = IntVec2(i, m_MapHeight - 1);
+			allTests.back().Dir = directions[3];
 		}
 
 		// East/West Rows
-		// All top/bottom rows, heading down/up.
 		for (uint32_t i = 0; i < m_MapHeight; ++i)
 		{
-			// Up heading down
-			TestResults resultsA;
-			resultsA.Pos = IntVec2(-1, i);
-			resultsA.Dir = directions[0];
+			allTests.emplace_back();
+			allTests.back().Pos = IntVec2(0, i);
+			allTests.back().Dir = directions[0];
 
-			GetEnergyForTest(resultsA);
-
-			Log("Test [%d, %d] with Direction [%d, %d] came back with %zd total energy.", resultsA.Pos.x, resultsA.Pos.y, resultsA.Dir.x, resultsA.Dir.y, resultsA.TotalEnergy);
-
-			allTests.push_back(resultsA);
-
-			// Down heading up
-			TestResults resultsB;
-			resultsB.Pos = (m_MapWidth, i);
-			resultsB.Dir = directions[2];
-
-			GetEnergyForTest(resultsB);
+			allTests.emplace_back();
+			allTests.back().Pos = IntVec2(m_MapWidth - 1, i);
+			allTests.back().Dir = directions[2];
+		}
 
-			Log("Test [%d, %d] with Direction [%d, %d] came back with %zd total energy.", resultsB.Pos.x, resultsB.Pos.y, resultsB.Dir.x, resultsB.Dir.y, resultsB.TotalEnergy);
+		// Every entry is answered from the condensed graph's cached coverage.
+		Log("Splitter graph has %u nodes in %u components.", m_SplitterGraph->GetNodeCount(), m_SplitterGraph->GetComponentCount());
+		const uint32_t workerCount = Parallel::GetWorkerCount(allTests.size());
+		std::vector<std::vector<uint64_t>> workerTiles(workerCount);
+		Parallel::ForEach(allTests.size(), [&](uint32_t workerIndex, size_t testIndex)
+		{
+			TestResults& test = allTests[testIndex];
+			const uint32_t entryTile = m_BeamEngine->GetTileIndex(test.Pos.x, test.Pos.y);
+			const uint32_t entryDir = BeamEngine::GetDirFromVelocity(test.Dir);
+			test.TotalEnergy = m_SplitterGraph->Energize(entryTile, entryDir, workerTiles[workerIndex]);
+		});
 
-			allTests.push_back(resultsB);
+		for (const TestResults& test : allTests)
+		{
+			Log("Test [%d, %d] with Direction [%d, %d] came back with %zd total energy.", test.Pos.x, test.Pos.y, test.Dir.x, test.Dir.y, test.TotalEnergy);
 		}
 
 		std::sort(allTests.begin(), allTests.end(),[](const TestResults& LHS, const TestResults& RHS){ return LHS.TotalEnergy > RHS.TotalEnergy; });
@@ -483,16 +926,16 @@ private:
 		AdventGUIInstance::PartTwo(context);
 	}
 
-	uint32_t m_lastStableStep;
 	uint32_t m_totalSimSteps;
 	std::vector<char> m_Map;
 	uint32_t m_MapWidth;
 	uint32_t m_MapHeight;
 	uint32_t m_ActiveIndex;
+	std::unique_ptr<BeamEngine> m_BeamEngine;
+	std::unique_ptr<SplitterGraph> m_SplitterGraph;
 	std::unordered_set<IntVec4> m_ActiveLights[2];
-	std::unordered_set<IntVec2> m_TouchedTiles;
+	std::vector<uint64_t> m_VisitedTiles;
 	bool m_AutoStep;
-	float m_SimHz;
 };
 
 int main()
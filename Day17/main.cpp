@@ -3,232 +3,251 @@
 
 #include "AdventGUI/AdventGUI.h"
 
-#include "ACUtils/Algorithm.h"
-#include "ACUtils/AStar.h"
-#include "ACUtils/Hash.h"
+#include "ACUtils/Debug.h"
 #include "ACUtils/IntVec.h"
 #include "ACUtils/StringUtil.h"
 
+#include <vector>
 
-class CrucibleGridNode : public AStar::AStarNodeBase<uint32_t>
+// Minimum heat loss router for the crucible movement model (must go straight for [minRun, maxRun] cells, then turn left or right).
+//
+// Every search state is packed into a single integer:
+//		((y * width + x) * 4 + dir) * runSlots + (run - 1)
+// and costs live in one dense array indexed by that state, so there's no per-node allocation or hashing.
+// Edge costs are small integers, so the open list is a bucket queue (Dial's algorithm) rather than a heap.
+class CrucibleRouter
 {
 public:
-	CrucibleGridNode(const IntVec2& pos, const IntVec2& dir, const IntVec2& goal, uint32_t totalHeatLoss, uint32_t timeSinceLastTurn, uint32_t minTimeForTurn, uint32_t maxTimeForTurn)
-	:m_hash(0),
-	m_pos(pos), 
-	m_goalPos(goal), 
-	m_dir(dir),
-	m_timeSinceLastTurn(timeSinceLastTurn),
-	m_totalHeatLoss(totalHeatLoss),
-	m_minTimeForTurn(minTimeForTurn),
-	m_maxTimeForTurn(maxTimeForTurn)
+	enum class ExpansionMode : uint8_t
 	{
-		m_hash |= pos.x << 0;
-		m_hash |= pos.y << 8;
-		
-		if (m_dir.x != 0)
-		{
-			m_hash |= 1 << (m_dir.x > 0 ? 16 : 17); 
-		}
+		StepByStep = 0, // Move a single cell per relaxation, the state tracks the current run length. W x H x 4 x maxRun states.
+		CollapsedRuns,	// Each relaxation moves 1..maxRun cells in a straight line and must then turn. Run length drops out of the state, W x H x 4 states.
+	};
 
-		if (m_dir.y != 0)
+	static constexpr uint32_t NO_PATH = ~0U;
+
+	CrucibleRouter(const std::vector<uint8_t>& heatMap, uint32_t mapWidth, uint32_t mapHeight)
+	: m_heatMap(heatMap),
+	m_mapWidth(mapWidth),
+	m_mapHeight(mapHeight),
+	m_maxHeat(0)
+	{
+		assert(m_heatMap.size() == (size_t)m_mapWidth * m_mapHeight);
+		for (uint8_t heat : m_heatMap)
 		{
-			m_hash |= 1 << (m_dir.y > 0 ? 18 : 19);
+			m_maxHeat = std::max(m_maxHeat, (uint32_t)heat);
 		}
-
-		m_hash |= m_timeSinceLastTurn << 20;
 	}
 
-	virtual size_t GetHash() const override { return m_hash; }
-	virtual bool IsAtGoal() const override { return m_pos == m_goalPos && m_timeSinceLastTurn >= m_minTimeForTurn; }
-	const IntVec2& GetPos() const { return m_pos; }
-	const IntVec2& GetDir() const { return m_dir; }
-	uint32_t GetTimeSinceLastTurn() const { return m_timeSinceLastTurn; }
-	uint32_t GetTotalHeatLoss() const { return m_totalHeatLoss; }
-	uint32_t GetMinTimeForTurn() const { return m_minTimeForTurn; }
-	uint32_t GetMaxTimeForTurn() const { return m_maxTimeForTurn; }
-	void SetDir(const IntVec2& dir) { m_dir = dir; }
-	IntVec2 GetForward() const { return m_dir; }
-	IntVec2 GetLeft() const 
-	{ 
-		if (m_dir.x != 0)
+	// Returns the minimum heat loss going from the top left to the bottom right, or NO_PATH.
+	uint32_t Solve(uint32_t minRun, uint32_t maxRun, ExpansionMode mode)
+	{
+		assert(minRun <= maxRun && maxRun > 0);
+		if (m_mapWidth * m_mapHeight <= 1)
 		{
-			if (m_dir.x > 0)
-			{
-				return IntVec2(0, -1);
-			}
-			else
-			{
-				return IntVec2(0, 1);
-			}
+			return 0;
 		}
-		else
+
+		m_minRun = std::max(minRun, 1U);
+		m_maxRun = maxRun;
+		m_mode = mode;
+		m_runSlots = m_mode == ExpansionMode::StepByStep ? m_maxRun : 1;
+
+		const size_t totalStates = (size_t)m_mapWidth * m_mapHeight * 4 * m_runSlots;
+		assert(totalStates < NO_PATH);
+		m_costs.assign(totalStates, (uint32_t)NO_PATH);
+		m_queue.Reset(std::max(m_maxHeat, 1U) * (m_mode == ExpansionMode::StepByStep ? 1 : m_maxRun));
+
+		// We can head out either East or South from the start.
+		for (uint32_t dir : { DIR_EAST, DIR_SOUTH })
 		{
-			if (m_dir.y > 0)
+			if (m_mode == ExpansionMode::StepByStep)
 			{
-				return IntVec2(1, 0);
+				RelaxStep(0, 0, dir, 1, 0);
 			}
 			else
 			{
-				return IntVec2(-1, 0);
+				RelaxRun(0, 0, dir, 0);
 			}
 		}
-	}
-	IntVec2 GetRight() const 
-	{ 
-		if (m_dir.x != 0)
+
+		const uint32_t goalCell = m_mapWidth * m_mapHeight - 1;
+		uint32_t cost = 0;
+		uint32_t state = 0;
+		while (m_queue.Pop(cost, state))
 		{
-			if (m_dir.x > 0)
+			// Stale entry, we've already found a cheaper way here.
+			if (cost != m_costs[state])
 			{
-				return IntVec2(0, 1);
+				continue;
 			}
-			else
+
+			const uint32_t run = (state % m_runSlots) + 1;
+			const uint32_t dir = (state / m_runSlots) & 3;
+			const uint32_t cell = state / (m_runSlots * 4);
+
+			// Runs are always complete in collapsed mode.
+			if (cell == goalCell && (m_mode == ExpansionMode::CollapsedRuns || run >= m_minRun))
 			{
-				return IntVec2(0, -1);
+				return cost;
 			}
-		}
-		else
-		{
-			if (m_dir.y > 0)
+
+			const uint32_t x = cell % m_mapWidth;
+			const uint32_t y = cell / m_mapWidth;
+			if (m_mode == ExpansionMode::StepByStep)
 			{
-				return IntVec2(-1, 0);
+				if (run < m_maxRun)
+				{
+					RelaxStep(x, y, dir, run + 1, cost);
+				}
+
+				if (run >= m_minRun)
+				{
+					RelaxStep(x, y, TurnLeft(dir), 1, cost);
+					RelaxStep(x, y, TurnRight(dir), 1, cost);
+				}
 			}
 			else
 			{
-				return IntVec2(1, 0);
+				RelaxRun(x, y, TurnLeft(dir), cost);
+				RelaxRun(x, y, TurnRight(dir), cost);
 			}
 		}
+
+		return NO_PATH;
 	}
-public:
-	size_t m_hash;
-	IntVec2 m_pos;
-	IntVec2 m_goalPos;
-	IntVec2 m_dir;
-	uint32_t m_timeSinceLastTurn;
-	uint32_t m_totalHeatLoss;
-	uint32_t m_minTimeForTurn;
-	uint32_t m_maxTimeForTurn;
-};
 
-class CrucibleExecuter : public AStar::AStarExecuter<uint32_t>
-{
-public:
-	CrucibleExecuter(const IntVec2& inGoal, const std::vector<uint32_t>& inMap, uint32_t mapWidth, AStar::AStarLogger logger = nullptr, uint32_t minGoalDistance = 0) 
-	: AStarExecuter<uint32_t>(logger),
-	m_map(inMap), 
-	m_mapWidth(mapWidth), 
-	m_goalPos(inGoal) 
-	{ 
-		m_mapHeight = (uint32_t)m_map.size() / m_mapWidth; 
-	};
+private:
+	static constexpr uint32_t DIR_EAST = 0;
+	static constexpr uint32_t DIR_SOUTH = 1;
+	static constexpr uint32_t DIR_WEST = 2;
+	static constexpr uint32_t DIR_NORTH = 3;
+
+	static constexpr uint32_t TurnLeft(uint32_t dir) { return (dir + 3) & 3; }
+	static constexpr uint32_t TurnRight(uint32_t dir) { return (dir + 1) & 3; }
 
-	static uint32_t GetManhattanDistance(const struct IntVec2& a, const IntVec2& b)
+	// Steps (x, y) one cell in dir, returns false if that walks off the map.
+	bool Step(uint32_t& x, uint32_t& y, uint32_t dir) const
 	{
-		return abs(a.x - b.x) + abs(a.y - b.y);
+		switch (dir)
+		{
+		case DIR_EAST: return ++x < m_mapWidth;
+		case DIR_SOUTH: return ++y < m_mapHeight;
+		case DIR_WEST: return x-- > 0;
+		case DIR_NORTH:
+		default: return y-- > 0;
+		}
 	}
 
-	uint32_t GetHeatLoss(const IntVec2& pos) const
+	uint32_t PackState(uint32_t x, uint32_t y, uint32_t dir, uint32_t run) const
 	{
-		return m_map[pos.y * m_mapWidth + pos.x];
+		return ((y * m_mapWidth + x) * 4 + dir) * m_runSlots + (run - 1);
 	}
 
-	bool IsValidMove(const CrucibleGridNode* node, const IntVec2& dir) const
+	void Relax(uint32_t state, uint32_t cost)
 	{
-		IntVec2 nextPos = node->GetPos() + dir;
-
-		if (nextPos.x < 0 || nextPos.y < 0 || nextPos.x >= (int32_t)m_mapWidth || nextPos.y >= (int32_t)m_mapHeight)
+		if (cost < m_costs[state])
 		{
-			return false;
+			m_costs[state] = cost;
+			m_queue.Push(cost, state);
 		}
+	}
 
-		if (node->GetDir() == dir)
+	// Single cell move, run is the length of our straight run once we've taken the step.
+	void RelaxStep(uint32_t x, uint32_t y, uint32_t dir, uint32_t run, uint32_t cost)
+	{
+		if (Step(x, y, dir))
 		{
-			return node->GetTimeSinceLastTurn() < node->GetMaxTimeForTurn();
+			Relax(PackState(x, y, dir, run), cost + m_heatMap[y * m_mapWidth + x]);
 		}
+	}
 
-		if (dir == node->GetLeft() || dir == node->GetRight())
+	// Walks the full straight run in dir, every stop in [minRun, maxRun] is a state we can turn from.
+	void RelaxRun(uint32_t x, uint32_t y, uint32_t dir, uint32_t cost)
+	{
+		for (uint32_t run = 1; run <= m_maxRun; ++run)
 		{
-			return node->GetTimeSinceLastTurn() >= node->GetMinTimeForTurn();
-		}
+			if (!Step(x, y, dir))
+			{
+				return;
+			}
 
-		return false;
+			cost += m_heatMap[y * m_mapWidth + x];
+			if (run >= m_minRun)
+			{
+				Relax(PackState(x, y, dir, 1), cost);
+			}
+		}
 	}
 
-	virtual void OnProcessNode(AStar::AStarNodeBase<uint32_t>& CurrentNode) override
+	// Monotone bucket queue. Every pending cost is within [current, current + maxEdgeCost], so a ring of buckets covers them all.
+	class BucketQueue
 	{
-		const CrucibleGridNode* currentNode = CurrentNode.As<CrucibleGridNode>();
-		IntVec2 currentPos;
+	public:
+		void Reset(uint32_t maxEdgeCost)
+		{
+			uint32_t bucketCount = 1;
+			while (bucketCount <= maxEdgeCost)
+			{
+				bucketCount <<= 1;
+			}
 
-		//Log("Evaluating Node [%d, %d]", currentNode->GetPos().x, currentNode->GetPos().y);
+			m_buckets.resize(bucketCount);
+			for (std::vector<uint32_t>& bucket : m_buckets)
+			{
+				bucket.clear();
+			}
+			m_bucketMask = bucketCount - 1;
+			m_currentCost = 0;
+			m_pending = 0;
+		}
 
-		const IntVec2 possibleChoices[] = { currentNode->GetForward(), currentNode->GetLeft(), currentNode->GetRight() };
+		void Push(uint32_t cost, uint32_t state)
+		{
+			assert(cost >= m_currentCost && cost - m_currentCost <= m_bucketMask);
+			m_buckets[cost & m_bucketMask].push_back(state);
+			++m_pending;
+		}
 
-		for (const IntVec2& choice : possibleChoices)
+		bool Pop(uint32_t& outCost, uint32_t& outState)
 		{
-			if (!IsValidMove(currentNode, choice))
+			if (m_pending == 0)
 			{
-				continue;
+				return false;
 			}
 
-			CrucibleGridNode* newNode = new CrucibleGridNode(
-			currentNode->GetPos() + choice, 
-			choice, 
-			m_goalPos, 
-			currentNode->GetTotalHeatLoss() + GetHeatLoss(currentNode->GetPos() + choice),
-			(choice == currentNode->GetForward() ? currentNode->GetTimeSinceLastTurn() + 1 : 1),
-			currentNode->GetMinTimeForTurn(), currentNode->GetMaxTimeForTurn());
-			newNode->SetParent(currentNode);
-			newNode->SetHeuristic(1); // H
-			newNode->SetCost(newNode->GetTotalHeatLoss()); // G
-
-			const AStar::AStarNodeBase<uint32_t>* closedNode = GetClosedListNode(newNode);
-			if (closedNode)
+			while (m_buckets[m_currentCost & m_bucketMask].empty())
 			{
-				// Skip it.
-				delete newNode;
-				continue;
+				++m_currentCost;
 			}
 
-			// See if we have a better cost than an existing entry in the open list.
-			int32_t existingIndex = FindIndexInOpenList(newNode);
-			if (existingIndex != -1)
-			{
-				CrucibleGridNode* existingNode = m_openList[existingIndex]->As<CrucibleGridNode>();
-				if (newNode->GetCost() < existingNode->GetCost())
-				{
-					m_openList[existingIndex] = newNode;
-					ReInsertNode(existingIndex);
-					delete existingNode;
-					continue;
-				}
-				else
-				{
-					delete newNode;
-					continue;
-				}
-			}
-			//Log("\t- New Node. Added [%d, %d] Dir [%d, %d], G [%u] H[%u] F [%u].",
-			//	newNode->GetPos().x, newNode->GetPos().y,
-			//	newNode->GetDir().x, newNode->GetDir().y,
-			//	newNode->GetCost(), newNode->GetHeuristic(), newNode->GetTotalCost());
-			// Insert into the open list
-			InsertNode(newNode);
+			std::vector<uint32_t>& bucket = m_buckets[m_currentCost & m_bucketMask];
+			outCost = m_currentCost;
+			outState = bucket.back();
+			bucket.pop_back();
+			--m_pending;
+			return true;
 		}
 
+	private:
+		std::vector<std::vector<uint32_t>> m_buckets;
+		uint32_t m_bucketMask = 0;
+		uint32_t m_currentCost = 0;
+		size_t m_pending = 0;
+	};
 
-	}
-private:
-	std::vector<uint32_t> m_map;
+	const std::vector<uint8_t>& m_heatMap;
 	uint32_t m_mapWidth;
 	uint32_t m_mapHeight;
-	IntVec2  m_goalPos;
+	uint32_t m_maxHeat;
+	uint32_t m_minRun = 1;
+	uint32_t m_maxRun = 1;
+	uint32_t m_runSlots = 1;
+	ExpansionMode m_mode = ExpansionMode::CollapsedRuns;
+	std::vector<uint32_t> m_costs;
+	BucketQueue m_queue;
 };
 
-void AStarLogFunc(const char* fmt, va_list args)
-{
-	AdventGUIInstance::Get()->VLog(fmt, args);
-}
-
 class AdventDay : public AdventGUIInstance
 {
 public:
@@ -249,154 +268,56 @@ private:
 			if (m_MapWidth == 0)
 			{
 				m_MapWidth = (uint32_t)line.size();
-				m_Map.reserve(m_MapWidth * m_MapWidth); 
+				m_Map.reserve(m_MapWidth * m_MapWidth);
 			}
 			assert(m_MapWidth == (uint32_t)line.size());
 			for (char c : line)
 			{
-				m_Map.push_back(c - '0');
+				m_Map.push_back((uint8_t)(c - '0'));
 			}
 		}
 
 		m_MapHeight = (uint32_t)m_Map.size() / m_MapWidth;
 	}
 
-	void DrawMapAndPath(const std::vector<const CrucibleGridNode*>& path) const
+	void SolveAndLog(uint32_t minRun, uint32_t maxRun) const
 	{
-		char displayBuffer[2048] = { 0 };
-		char* writePtr = displayBuffer;
-		for (uint32_t i = 0; i < m_MapHeight; ++i)
+		CrucibleRouter router(m_Map, m_MapWidth, m_MapHeight);
+		uint32_t totalHeatLoss = router.Solve(minRun, maxRun, CrucibleRouter::ExpansionMode::CollapsedRuns);
+		if (totalHeatLoss != CrucibleRouter::NO_PATH)
 		{
-			for (uint32_t j = 0; j < m_MapWidth; ++j)
-			{
-				int32_t pathIndex = Algorithm::find_index_of(path.begin(), path.end(), [&](const CrucibleGridNode* RHS) { return RHS->GetPos() == IntVec2(j, i); });
-				if (pathIndex != -1 && path[pathIndex]->m_dir != IntVec2::Zero)
-				{
-					const IntVec2& dir = path[pathIndex]->m_dir;
-					if (dir.x != 0)
-					{
-						*writePtr = dir.x > 0 ? '>' : '<';
-					}
-					else
-					{
-						*writePtr = dir.y > 0 ? 'v' : '^';
-					}
-				}
-				else
-				{
-					*writePtr = '0' + m_Map[i * m_MapWidth + j];
-				}
-				++writePtr;
-			}
-			*writePtr = '\n';
-			++writePtr;
-			*writePtr = '\t';
-			++writePtr;
-		}
-		*writePtr = '\0';
-
-		Log("Map:\n\t%s", displayBuffer);
-	}
-
-	virtual void PartOne(const AdventGUIContext& context) override
-	{
-		// Part One
-		const IntVec2 goal(m_MapWidth - 1, m_MapHeight - 1);
-
-		CrucibleExecuter executer(goal, m_Map, m_MapWidth, &AStarLogFunc);
-		CrucibleGridNode* initialNode = new CrucibleGridNode(IntVec2::Zero, IntVec2(1,0), goal, 0, 1, 0, 3);
-		executer.InsertNode(initialNode);
-
-		std::vector<const CrucibleGridNode*> solvedPath;
-		const AStar::AStarNodeBase<uint32_t>* pathNode = nullptr;
-
-		uint32_t totalHeatLoss = 0;
-		if (executer.Solve(pathNode))
-		{
-			// Chain up for the path route
-			while (pathNode)
-			{
-				solvedPath.push_back(pathNode->As<CrucibleGridNode>());
-				IntVec2 nodePos = solvedPath.back()->GetPos();
-				if (pathNode->GetParent())
-				{
-					totalHeatLoss += m_Map[nodePos.y * m_MapWidth + nodePos.x];
-				}
-
-				pathNode = pathNode->GetParent();
-			}
-			
-			
-			//Log("Completed Path:");
-			for (const CrucibleGridNode* path : solvedPath)
-			{
-				//Log("\t- Pos [%d, %d] Dir[%d, %d] HL [%u]", path->GetPos().x, path->GetPos().y, path->GetDir().x, path->GetDir().y, m_Map[path->GetPos().y * m_MapWidth + path->GetPos().x]);
-			}
-
-			//DrawMapAndPath(solvedPath);
-
 			Log("Total Heat Loss: %u", totalHeatLoss);
 		}
 		else
 		{
-			// No path found
 			Log("No Path Found.");
 		}
+	}
+
+	virtual void PartOne(const AdventGUIContext& context) override
+	{
+		// Part One
+		SolveAndLog(CRUCIBLE_MIN_RUN, CRUCIBLE_MAX_RUN);
 
 		// Done.
 		AdventGUIInstance::PartOne(context);
-
 	}
 
 	virtual void PartTwo(const AdventGUIContext& context) override
 	{	
 		// Part Two
-		const IntVec2 goal(m_MapWidth - 1, m_MapHeight - 1);
-
-		CrucibleExecuter executer(goal, m_Map, m_MapWidth, &AStarLogFunc);
-		CrucibleGridNode* initialEastNode = new CrucibleGridNode(IntVec2::Zero, IntVec2(1, 0), goal, 0, 1, 4, 10);
-		executer.InsertNode(initialEastNode);
-		CrucibleGridNode* initialSouthNode = new CrucibleGridNode(IntVec2::Zero, IntVec2(0, 1), goal, 0, 1, 4, 10);
-		executer.InsertNode(initialSouthNode);
-
-		std::vector<const CrucibleGridNode*> solvedPath;
-		const AStar::AStarNodeBase<uint32_t>* pathNode = nullptr;
-		uint32_t totalHeatLoss = 0;
-		if (executer.Solve(pathNode))
-		{
-			// Chain up for the path route
-			while (pathNode)
-			{
-				solvedPath.push_back(pathNode->As<CrucibleGridNode>());
-				IntVec2 nodePos = solvedPath.back()->GetPos();
-				if (pathNode->GetParent())
-				{
-					totalHeatLoss += m_Map[nodePos.y * m_MapWidth + nodePos.x];
-				}
-
-				pathNode = pathNode->GetParent();
-			}
-
-			//Log("Completed Path:");
-			for (const CrucibleGridNode* path : solvedPath)
-			{
-				//Log("\t- Pos [%d, %d] Dir[%d, %d] HL [%u]", path->GetPos().x, path->GetPos().y, path->GetDir().x, path->GetDir().y, m_Map[path->GetPos().y * m_MapWidth + path->GetPos().x]);
-			}
-
-			//DrawMapAndPath(solvedPath);
-
-			Log("Total Heat Loss: %u", totalHeatLoss);
-		}
-		else
-		{
-			Log("No Path Found.");
-		}
+		SolveAndLog(ULTRA_CRUCIBLE_MIN_RUN, ULTRA_CRUCIBLE_MAX_RUN);
 
 		// Done.
 		AdventGUIInstance::PartTwo(context);
 	}
 
-	std::vector<uint32_t> m_Map;
+	static constexpr uint32_t CRUCIBLE_MIN_RUN = 1;
+	static constexpr uint32_t CRUCIBLE_MAX_RUN = 3;
+	static constexpr uint32_t ULTRA_CRUCIBLE_MIN_RUN = 4;
+	static constexpr uint32_t ULTRA_CRUCIBLE_MAX_RUN = 10;
+
+	std::vector<uint8_t> m_Map;
 	uint32_t m_MapWidth;
 	uint32_t m_MapHeight;
 };
@@ -5,6 +5,7 @@
 
 #include "ACUtils/IntVec.h"
 #include "ACUtils/AABB.h"
+#include "ACUtils/Polygon.h"
 #include "ACUtils/StringUtil.h"
 #include <vector>
 #include <cinttypes>
@@ -20,7 +21,6 @@ private:
 	{
 		// Parse Input. Input never changes between parts of a problem.
 		IntVec2 currentPoint(0, 0);
-		Int64Vec2 partTwoCurrentPoint(0, 0);
 
 		m_Bounds = IntAABB2D(currentPoint, 1);
 
@@ -55,7 +55,6 @@ private:
 			}
 
 			int32_t length = atoi(tokens[1].c_str());
-			m_totalWalk += length;
 			assert(tokens[2].size() == 9);
 			uint32_t color = 0;
 			std::string hexStr = tokens[2].substr(2, 6).c_str();
@@ -64,11 +63,9 @@ private:
 			IntVec2 offset = directions[directionIndex] * length;
 			m_Edges.emplace_back(currentPoint, currentPoint + offset, (uint32_t)color);
 			
-			m_partTwoTotalWalk += (color >> 4);
+			// Part two's plan can get long, so it's folded into the area as it's read rather than stored.
 			Int64Vec2 partTwoOffset = partTwoDirections[(color & 3)] * (color >> 4);
-			Int64Vec2 partTwoPoint = partTwoCurrentPoint + partTwoOffset;
-			m_PointsP2.emplace_back(partTwoPoint);
-			partTwoCurrentPoint = m_PointsP2.back();
+			m_PartTwoArea.AddMove(partTwoOffset.x, partTwoOffset.y);
 
 			currentPoint = m_Edges.back().End;
 			m_Bounds = m_Bounds.ExpandToContain(currentPoint);
@@ -123,40 +120,6 @@ private:
 		ImGui::End();
 	}
 
-	uint64_t GetArea32(const std::vector<IntVec2>& allPoints, uint64_t surfaceArea) const
-	{
-		// Shoelace
-		int64_t areaSansPerimeter = 0LL;
-
-		for (size_t i = 0; i < allPoints.size(); ++i) 
-		{
-			int j = (i + 1) % allPoints.size();
-			areaSansPerimeter += (int64_t)(allPoints[i].x * allPoints[j].y) - (int64_t)(allPoints[j].x * allPoints[i].y);
-		}
-
-		// Pick's
-		uint64_t interior =  (uint64_t)(abs(areaSansPerimeter) / 2);
-		uint64_t perimeter = (surfaceArea / 2) + 1;
-		return interior + perimeter;
-	}
-
-	uint64_t GetArea64(const std::vector<Int64Vec2>& allPoints, uint64_t surfaceArea) const
-	{
-		// Shoelace
-		int64_t areaSansPerimeter = 0LL;
-
-		for (size_t i = 0; i < allPoints.size(); ++i)
-		{
-			int j = (i + 1) % allPoints.size();
-			areaSansPerimeter += (int64_t)(allPoints[i].x * allPoints[j].y) - (int64_t)(allPoints[j].x * allPoints[i].y);
-		}
-
-		// Pick's
-		uint64_t interior = (uint64_t)(abs(areaSansPerimeter) / 2);
-		uint64_t perimeter = (surfaceArea / 2) + 1;
-		return interior + perimeter;
-	}
-
 	virtual void PartOne(const AdventGUIContext& context) override
 	{
 		// Part One
@@ -170,9 +133,11 @@ private:
 			allPoints.push_back(edge.End);
 		}
 
-		uint64_t cubicArea = GetArea32(allPoints, m_totalWalk);
+		// Every dug cube is a lattice point on or inside the trench loop.
+		const Int128 cubicArea = Polygon::GetLatticeArea(allPoints).GetTotalPoints();
+		assert(cubicArea.FitsInt64());
 
-		Log("Total Area = %" PRIu64, cubicArea);
+		Log("Total Area = %" PRIu64, (uint64_t)cubicArea.ToInt64());
 		// Done.
 		AdventGUIInstance::PartOne(context);
 	}
@@ -180,9 +145,10 @@ private:
 	virtual void PartTwo(const AdventGUIContext& context) override
 	{	
 		// Part Two
-		uint64_t cubicArea = GetArea64(m_PointsP2, m_partTwoTotalWalk);
+		const Int128 cubicArea = m_PartTwoArea.Finish().GetTotalPoints();
+		assert(cubicArea.FitsInt64());
 
-		Log("Total Area = %" PRIu64, cubicArea);
+		Log("Total Area = %" PRIu64, (uint64_t)cubicArea.ToInt64());
 
 		// Done.
 		AdventGUIInstance::PartTwo(context);
@@ -196,11 +162,9 @@ private:
 		IntVec2 End;
 		uint32_t Color;
 	};
-	uint32_t m_totalWalk;
-	uint64_t m_partTwoTotalWalk;
 	IntAABB2D m_Bounds;
 	std::vector<Vert> m_Edges;
-	std::vector<Int64Vec2> m_PointsP2;
+	Polygon::LatticeAccumulator m_PartTwoArea;
 	uint32_t m_MapWidth;
 };
 
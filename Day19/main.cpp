@@ -4,315 +4,228 @@
 #include "AdventGUI/AdventGUI.h"
 
 #include "ACUtils/IntVec.h"
-#include "ACUtils/Hash.h"
 #include "ACUtils/StringUtil.h"
 #include <vector>
-#include <unordered_set>
+#include <unordered_map>
 #include <cinttypes>
-#include <stack>
+#include <cstring>
 
-enum class ResultCode : uint8_t
+// All the workflows flattened into one rule array. Every jump is resolved to the index of the first rule in the target
+// workflow, so running a part is just stepping a program counter until it lands on ACCEPT or REJECT.
+class WorkflowProgram
 {
-	RC_None = 0,
-	RC_Rejected,
-	RC_Accepted,
-	RC_Jump,
-};
+public:
+	static constexpr uint32_t REJECT = 0xFFFFFFFE;
+	static constexpr uint32_t ACCEPT = 0xFFFFFFFF;
 
-enum class TestAttribute : uint8_t
-{
-	TA_X = 0,
-	TA_M,
-	TA_A,
-	TA_S,
-};
+	// Every test is "(value < Split) == PassBelow". An unconditional rule is Split 0, PassBelow false, which always passes.
+	struct Rule
+	{
+		uint8_t Attribute;
+		bool PassBelow;
+		int32_t Split;
+		uint32_t Target; // Rule index, ACCEPT, or REJECT.
+	};
 
-enum class TestOp : uint8_t
-{
-	OP_LT,
-	OP_GT,
-	OP_CONSTANT,
-};
+	// Node in the k-d tree the rules fold into. Values below Split go to Children[0], the rest to Children[1].
+	struct DecisionNode
+	{
+		uint8_t Attribute;
+		int32_t Split;
+		uint32_t Children[2]; // Node index, ACCEPT, or REJECT.
+	};
 
-struct Statement
-{
-	Statement(const std::string& rawStr)
-		:RawString(rawStr),
-		Attribute(TestAttribute::TA_A),
-		Op(TestOp::OP_CONSTANT),
-		ResultOnSuccess(ResultCode::RC_Rejected),
-		Param(0)
+	// "px{a<2006:qkq,m>2090:A,rfg}"
+	void AddWorkflow(const std::string& line)
 	{
-		size_t colonIdx = rawStr.find(':');
-		if (colonIdx == std::string::npos)
+		std::vector<std::string> tokens;
+		StringUtil::SplitBy(line, "{|}|,", tokens);
+		assert(tokens.size() >= 2);
+
+		const uint32_t workflowIndex = GetWorkflowIndex(tokens[0]);
+		assert(m_workflowFirstRule[workflowIndex] == INVALID_RULE); // Defined twice?
+		m_workflowFirstRule[workflowIndex] = (uint32_t)m_rules.size();
+
+		for (size_t i = 1; i < tokens.size(); ++i)
 		{
-			Op = TestOp::OP_CONSTANT;
-			if (rawStr.size() == 1)
-			{
-				switch (rawStr[0])
-				{
-				case 'R': ResultOnSuccess = ResultCode::RC_Rejected; break;
-				case 'A': ResultOnSuccess = ResultCode::RC_Accepted; break;
-				default: assert(false); break;
-				}
-			}
-			else
+			const std::string& token = tokens[i];
+			const size_t colonIdx = token.find(':');
+
+			Rule rule = { 0, false, 0, 0 };
+			std::string targetName = token;
+			if (colonIdx != std::string::npos)
 			{
-				ResultOnSuccess = ResultCode::RC_Jump;
-				JumpParam = Hash::HashString32(rawStr.c_str());
+				const char* attributeNames = "xmas";
+				const char* attributeName = strchr(attributeNames, token[0]);
+				assert(attributeName != nullptr && (token[1] == '<' || token[1] == '>'));
+				rule.Attribute = (uint8_t)(attributeName - attributeNames);
+
+				const int32_t threshold = atoi(token.substr(2, colonIdx - 2).c_str());
+				rule.PassBelow = token[1] == '<';
+				rule.Split = rule.PassBelow ? threshold : threshold + 1;
+				targetName = token.substr(colonIdx + 1);
 			}
+
+			// Stash the workflow index for now, Compile swaps it for a rule index once everything is defined.
+			rule.Target = targetName == "A" ? ACCEPT : (targetName == "R" ? REJECT : GetWorkflowIndex(targetName));
+			m_rules.push_back(rule);
 		}
-		else
-		{
-			switch (rawStr[0])
-			{
-			case 'x': Attribute = TestAttribute::TA_X; break;
-			case 'm': Attribute = TestAttribute::TA_M; break;
-			case 'a': Attribute = TestAttribute::TA_A; break;
-			case 's': Attribute = TestAttribute::TA_S; break;
-			default: assert(false); break;
-			}
-			assert(rawStr[1] == '<' || rawStr[1] == '>');
-			Op = (rawStr[1] == '<') ? TestOp::OP_LT : TestOp::OP_GT;
-			std::string compValue = rawStr.substr(2, colonIdx - 2);
-			std::string resultValue = rawStr.substr(colonIdx + 1);
+	}
 
-			Param = (uint32_t)atoi(compValue.c_str());
-			if (resultValue.size() == 1)
-			{
-				switch (resultValue[0])
-				{
-				case 'R': ResultOnSuccess = ResultCode::RC_Rejected; break;
-				case 'A': ResultOnSuccess = ResultCode::RC_Accepted; break;
-				default: assert(false); break;
-				}
-			}
-			else
+	void Compile()
+	{
+		for (Rule& rule : m_rules)
+		{
+			if (rule.Target != ACCEPT && rule.Target != REJECT)
 			{
-				ResultOnSuccess = ResultCode::RC_Jump;
-				JumpParam = Hash::HashString32(resultValue.c_str());
+				rule.Target = m_workflowFirstRule[rule.Target];
+				assert(rule.Target != INVALID_RULE); // Jump to a workflow that was never defined.
 			}
 		}
+
+		const std::unordered_map<std::string, uint32_t>::const_iterator itEntry = m_workflowIndices.find("in");
+		assert(itEntry != m_workflowIndices.end());
+		m_entryRule = m_workflowFirstRule[itEntry->second];
+
+		m_nodes.clear();
+		m_root = BuildNode(m_entryRule, IntVec4(MIN_RATING), IntVec4(MAX_RATING));
 	}
-	std::string RawString;
-	TestAttribute Attribute;
-	TestOp Op;
-	ResultCode ResultOnSuccess;
-	uint32_t Param;
-	uint32_t JumpParam;
-};
 
-struct Workflow
-{
-	Workflow(uint32_t _nameHash): NameHash(_nameHash){};
-	Workflow(const std::string& _rawString)
-		: NameHash(0),
-		RawString(_rawString)
+	// Straight interpretation of the rules. Returns ACCEPT or REJECT.
+	uint32_t Run(const IntVec4& part) const
 	{
-		std::vector<std::string> tokens;
-		StringUtil::SplitBy(RawString, "{|}|,", tokens);
-		NameHash = Hash::HashString32(tokens[0].c_str());
-		for (size_t i = 1; i < tokens.size(); ++i)
+		uint32_t ruleIndex = m_entryRule;
+		while (ruleIndex < REJECT)
 		{
-			LogicStatements.emplace_back(tokens[i]);
+			const Rule& rule = m_rules[ruleIndex];
+			ruleIndex = ((part[rule.Attribute] < rule.Split) == rule.PassBelow) ? rule.Target : ruleIndex + 1;
 		}
+		return ruleIndex;
 	}
 
-	size_t GetHash() const { return (size_t)NameHash; }
-	bool operator==(const Workflow& RHS) const
+	// Same answer as Run, but through the decision tree, one comparison per level.
+	uint32_t Classify(const IntVec4& part) const
 	{
-		return NameHash == RHS.NameHash;
+		uint32_t nodeIndex = m_root;
+		while (nodeIndex < REJECT)
+		{
+			const DecisionNode& node = m_nodes[nodeIndex];
+			nodeIndex = node.Children[part[node.Attribute] >= node.Split ? 1 : 0];
+		}
+		return nodeIndex;
 	}
 
-	uint32_t NameHash;
-	std::string RawString;
-	std::vector<Statement> LogicStatements;
-};
+	// How many parts with every rating in [MIN_RATING, MAX_RATING] get accepted.
+	uint64_t GetAcceptedCount() const
+	{
+		return GetAcceptedCount(m_root, IntVec4(MIN_RATING), IntVec4(MAX_RATING));
+	}
 
-ENABLE_STL_HASH(Workflow, GetHash);
+	size_t GetRuleCount() const { return m_rules.size(); }
+	size_t GetNodeCount() const { return m_nodes.size(); }
 
-struct TreeNode
-{
-	TreeNode(const Statement* statement) : Parent(nullptr), Children{ nullptr, nullptr }, NodeStatement(statement) {};
-	TreeNode* Parent;
-	TreeNode* Children[2];
-	const Statement* NodeStatement;
-};
+	static constexpr int32_t MIN_RATING = 1;
+	static constexpr int32_t MAX_RATING = 4000;
 
-class AdventDay : public AdventGUIInstance
-{
-public:
-	AdventDay(const AdventGUIParams& params)
-		: AdventGUIInstance(params)
-	{};
 private:
-	uint32_t GetAttributeValue(const IntVec4& part, TestAttribute attrib) const
-	{
-		return (uint32_t)part[static_cast<uint8_t>(attrib)];
-	}
+	static constexpr uint32_t INVALID_RULE = 0xFFFFFFFD;
 
-	ResultCode ExecuteWorkflow(const std::unordered_set<Workflow>& workflows, const IntVec4& part) const
+	uint32_t GetWorkflowIndex(const std::string& name)
 	{
-		ResultCode rc = ResultCode::RC_None;
-		uint32_t currentStatement = Hash::HashString32("in");
-
-		while (rc != ResultCode::RC_Accepted && rc != ResultCode::RC_Rejected)
+		const std::pair<std::unordered_map<std::string, uint32_t>::iterator, bool> result = m_workflowIndices.emplace(name, (uint32_t)m_workflowFirstRule.size());
+		if (result.second)
 		{
-			std::unordered_set<Workflow>::const_iterator itFind = workflows.find(Workflow(currentStatement));
-			assert(itFind != workflows.end());
-
-			for (const Statement& statement : itFind->LogicStatements)
-			{
-				bool statementSuccess = false;
-				if (statement.Op == TestOp::OP_CONSTANT)
-				{
-					statementSuccess = true;
-				}
-				else if (statement.Op == TestOp::OP_LT)
-				{
-					statementSuccess = GetAttributeValue(part, statement.Attribute) < statement.Param;
-				}
-				else
-				{
-					assert(statement.Op == TestOp::OP_GT);
-					statementSuccess = GetAttributeValue(part, statement.Attribute) > statement.Param;
-				}
-
-				if (statementSuccess)
-				{
-					if (statement.ResultOnSuccess == ResultCode::RC_Jump)
-					{
-						currentStatement = statement.JumpParam;
-					}
-					else
-					{
-						rc = statement.ResultOnSuccess;
-					}
-					break;
-				}
-			}
+			m_workflowFirstRule.push_back(INVALID_RULE);
 		}
-
-		return rc;
-	}
-
-	struct RangeState
-	{
-		RangeState(const Workflow* _workFlow, uint8_t _statementIndex, IntVec4 _min, IntVec4 _max): CurrentWorkflow(_workFlow), StatementIndex(_statementIndex), RangeMin(_min), RangeMax(_max) {}
-		const Workflow* CurrentWorkflow;
-		uint8_t StatementIndex;
-		IntVec4 RangeMin;
-		IntVec4 RangeMax;
-	};
-
-	uint64_t GetRangeStateScore(const RangeState& rs) const
-	{
-		IntVec4 Delta = (rs.RangeMax - rs.RangeMin) + IntVec4(1);
-		return (int64_t)Delta.x * (int64_t)Delta.y * (int64_t)Delta.z * (int64_t)Delta.w;
+		return result.first->second;
 	}
 
-
-	uint64_t GetValueSpace(std::stack<RangeState>& inOutStack, const RangeState& currentRangedState) const
+	// Runs every part in [boxMin, boxMax] through the rules at once, splitting the box whenever a rule cuts it. Identical
+	// leaves get merged on the way back up.
+	uint32_t BuildNode(uint32_t ruleIndex, const IntVec4& boxMin, const IntVec4& boxMax)
 	{
-		const Statement& statement = currentRangedState.CurrentWorkflow->LogicStatements[currentRangedState.StatementIndex];
-		uint8_t attributeIndex = (uint8_t)statement.Attribute;
-
-		RangeState FailedCase(currentRangedState.CurrentWorkflow, currentRangedState.StatementIndex + 1, currentRangedState.RangeMin, currentRangedState.RangeMax);
-
-		if (statement.Op == TestOp::OP_CONSTANT)
+		while (ruleIndex < REJECT)
 		{
-			if (statement.ResultOnSuccess == ResultCode::RC_Accepted)
+			const Rule& rule = m_rules[ruleIndex];
+			bool passes = false;
+			if (boxMax[rule.Attribute] < rule.Split)
 			{
-				return GetRangeStateScore(currentRangedState);
+				passes = rule.PassBelow;
 			}
-			else if (statement.ResultOnSuccess == ResultCode::RC_Jump)
+			else if (boxMin[rule.Attribute] >= rule.Split)
 			{
-				std::unordered_set<Workflow>::const_iterator itFind = m_Workflows.find(Workflow(statement.JumpParam));
-				assert(itFind != m_Workflows.end());
-				inOutStack.emplace(&(*itFind), 0,  currentRangedState.RangeMin, currentRangedState.RangeMax);
+				passes = !rule.PassBelow;
 			}
 			else
 			{
-				return 0;
-			}
-		}
-		else if (statement.Op == TestOp::OP_LT)
-		{
-			Log("Splitting to Ranges based on statement '%s'", statement.RawString.c_str());
-			if (currentRangedState.RangeMin[attributeIndex] >= statement.Param || currentRangedState.RangeMax[attributeIndex] < statement.Param)
-			{
-				// Impossible, toss on our failure state.
-				inOutStack.push(FailedCase);
-			}
-			else
-			{
-				IntVec4 newSuccessMax = currentRangedState.RangeMax;
-				newSuccessMax[attributeIndex] = statement.Param - 1;
-
-				IntVec4 newFailureMin = currentRangedState.RangeMin;
-				newFailureMin[attributeIndex] = statement.Param;
-
-
-
-				RangeState SuccessStateLow(nullptr, 0, currentRangedState.RangeMin, newSuccessMax);
-				RangeState SuccessStateHigh(currentRangedState.CurrentWorkflow, currentRangedState.StatementIndex + 1, newFailureMin, currentRangedState.RangeMax);
-
-				inOutStack.emplace(SuccessStateHigh); // Any failure / remainder.
-
-				if (statement.ResultOnSuccess == ResultCode::RC_Jump)
+				IntVec4 belowMax = boxMax;
+				belowMax[rule.Attribute] = rule.Split - 1;
+				IntVec4 aboveMin = boxMin;
+				aboveMin[rule.Attribute] = rule.Split;
+
+				DecisionNode node;
+				node.Attribute = rule.Attribute;
+				node.Split = rule.Split;
+				node.Children[0] = BuildNode(ruleIndex, boxMin, belowMax);
+				node.Children[1] = BuildNode(ruleIndex, aboveMin, boxMax);
+				if (node.Children[0] >= REJECT && node.Children[0] == node.Children[1])
 				{
-					std::unordered_set<Workflow>::const_iterator itFind = m_Workflows.find(Workflow(statement.JumpParam));
-					assert(itFind != m_Workflows.end());
-					SuccessStateLow.CurrentWorkflow = &(*itFind);
-					inOutStack.emplace(SuccessStateLow);
+					return node.Children[0];
 				}
-				else if (statement.ResultOnSuccess == ResultCode::RC_Accepted)
-				{
-					return GetRangeStateScore(SuccessStateLow);
-				}
-			}
-		}
-		else
-		{
-			assert(statement.Op == TestOp::OP_GT);
 
-			Log("Splitting to Ranges based on statement '%s'", statement.RawString.c_str());
-			if (currentRangedState.RangeMax[attributeIndex] < statement.Param)
-			{
-				// Impossible, toss on our failure state.
-				inOutStack.push(FailedCase);
+				m_nodes.push_back(node);
+				return (uint32_t)m_nodes.size() - 1;
 			}
-			else
-			{
-				IntVec4 newSuccessMin = currentRangedState.RangeMin;
-				newSuccessMin[attributeIndex] = statement.Param + 1;
 
-				IntVec4 newFailureMax = currentRangedState.RangeMax;
-				newFailureMax[attributeIndex] = statement.Param;
-
-				RangeState SuccessStateLow(nullptr, 0, newSuccessMin, currentRangedState.RangeMax);
-				RangeState SuccessStateHigh(currentRangedState.CurrentWorkflow, currentRangedState.StatementIndex + 1, currentRangedState.RangeMin, newFailureMax);
+			ruleIndex = passes ? rule.Target : ruleIndex + 1;
+		}
 
-				inOutStack.emplace(SuccessStateHigh); // Any failure / remainder.
+		return ruleIndex;
+	}
 
-				if (statement.ResultOnSuccess == ResultCode::RC_Jump)
-				{
-					std::unordered_set<Workflow>::const_iterator itFind = m_Workflows.find(Workflow(statement.JumpParam));
-					assert(itFind != m_Workflows.end());
+	uint64_t GetAcceptedCount(uint32_t nodeIndex, const IntVec4& boxMin, const IntVec4& boxMax) const
+	{
+		if (nodeIndex == REJECT)
+		{
+			return 0;
+		}
 
-					SuccessStateLow.CurrentWorkflow = &(*itFind);
-					inOutStack.emplace(SuccessStateLow);
-				}
-				else if (statement.ResultOnSuccess == ResultCode::RC_Accepted)
-				{
-					return GetRangeStateScore(SuccessStateLow);
-				}
-			}
+		if (nodeIndex == ACCEPT)
+		{
+			const IntVec4 delta = (boxMax - boxMin) + IntVec4(1);
+			return (uint64_t)delta.x * (uint64_t)delta.y * (uint64_t)delta.z * (uint64_t)delta.w;
 		}
 
-		return 0;
+		const DecisionNode& node = m_nodes[nodeIndex];
+		IntVec4 belowMax = boxMax;
+		belowMax[node.Attribute] = node.Split - 1;
+		IntVec4 aboveMin = boxMin;
+		aboveMin[node.Attribute] = node.Split;
+		return GetAcceptedCount(node.Children[0], boxMin, belowMax) + GetAcceptedCount(node.Children[1], aboveMin, boxMax);
 	}
 
+	std::unordered_map<std::string, uint32_t> m_workflowIndices;
+	std::vector<uint32_t> m_workflowFirstRule;
+	std::vector<Rule> m_rules;
+	uint32_t m_entryRule = INVALID_RULE;
+
+	std::vector<DecisionNode> m_nodes;
+	uint32_t m_root = REJECT;
+};
+
+constexpr uint32_t WorkflowProgram::REJECT;
+constexpr uint32_t WorkflowProgram::ACCEPT;
+constexpr uint32_t WorkflowProgram::INVALID_RULE;
+constexpr int32_t WorkflowProgram::MIN_RATING;
+constexpr int32_t WorkflowProgram::MAX_RATING;
+
+class AdventDay : public AdventGUIInstance
+{
+public:
+	AdventDay(const AdventGUIParams& params)
+		: AdventGUIInstance(params)
+	{};
+private:
 	virtual void ParseInput(FileStreamReader& fileReader) override
 	{
 		// Parse Input. Input never changes between parts of a problem.
@@ -344,9 +257,12 @@ private:
 			}
 			else
 			{
-				m_Workflows.emplace(line.c_str());
+				m_Program.AddWorkflow(line);
 			}
 		}
+
+		m_Program.Compile();
+		Log("Compiled %zd rules into a %zd node decision tree", m_Program.GetRuleCount(), m_Program.GetNodeCount());
 	}
 
 	virtual void PartOne(const AdventGUIContext& context) override
@@ -355,7 +271,8 @@ private:
 		uint64_t partTotal = 0;
 		for (const IntVec4& part : m_Parts)
 		{
-			if (ExecuteWorkflow(m_Workflows, part) == ResultCode::RC_Accepted)
+			assert(m_Program.Classify(part) == m_Program.Run(part));
+			if (m_Program.Classify(part) == WorkflowProgram::ACCEPT)
 			{
 				partTotal += (uint64_t)(part.x + part.y + part.z + part.w);
 			}
@@ -369,27 +286,14 @@ private:
 	virtual void PartTwo(const AdventGUIContext& context) override
 	{	
 		// Part Two
-		std::unordered_set<Workflow>::const_iterator itFind = m_Workflows.find(Workflow(Hash::HashString32("in")));
-		RangeState startState(&(*itFind), 0, IntVec4(1), IntVec4(4000));
-		std::stack<RangeState> rangeStack;
-		rangeStack.push(startState);
-		uint64_t totalArea = 0;
-		
-		while (!rangeStack.empty())
-		{
-			const RangeState currentState = rangeStack.top();
-			rangeStack.pop();
-
-			totalArea += GetValueSpace(rangeStack, currentState );
-		}
-		
+		const uint64_t totalArea = m_Program.GetAcceptedCount();
 		Log("Perms %" PRIu64, totalArea);
 
 		// Done.
 		AdventGUIInstance::PartTwo(context);
 	}
 
-	std::unordered_set<Workflow> m_Workflows;
+	WorkflowProgram m_Program;
 	std::vector<IntVec4> m_Parts;
 };
 
@@ -4,170 +4,298 @@
 #include "AdventGUI/AdventGUI.h"
 
 #include "ACUtils/Algorithm.h"
+#include "ACUtils/Bit.h"
+#include "ACUtils/Cycle.h"
 #include "ACUtils/Hash.h"
 #include "ACUtils/Math.h"
+#include "ACUtils/Parallel.h"
 #include "ACUtils/StringUtil.h"
 #include <vector>
 #include <cinttypes>
 #include <queue>
+#include <unordered_map>
 
-enum class ElfSignal : uint8_t
+// The module graph compiled down to flat arrays. Modules get dense ids, flip-flop state is one bitset, each conjunction remembers
+// its inputs as a bitmask (one bit per input edge), and pulses are just edge ids in a ring buffer. Pressing the button doesn't
+// allocate or dispatch through anything virtual.
+class CompiledCircuit
 {
-	ES_Low = 0,
-	ES_High
-};
+public:
+	enum class ModuleType : uint8_t
+	{
+		Sink = 0, // Named as a destination but never defined (rx, output).
+		Broadcaster,
+		FlipFlop,
+		Conjunction,
+	};
 
-class ElfModule;
-struct SignalMessage
-{
-	SignalMessage(ElfModule* _source, ElfModule* _dest, ElfSignal _signal):Source(_source), Destination(_dest), Signal(_signal){};
-	ElfModule* Source;
-	ElfModule* Destination;
-	ElfSignal Signal;
-};
+	static constexpr uint32_t INVALID_MODULE = ~0U;
+	static constexpr uint32_t MAX_CONJUNCTION_INPUTS = 64;
+	static constexpr uint32_t MAX_WATCHED_MODULES = 64;
 
-class ElfModule
-{
-public:
-	virtual void Execute(const SignalMessage& SignalMsg) = 0;
-	void AddOutputModule(ElfModule* output) { m_Outputs.emplace_back(output); }
-	const std::vector<ElfModule*>& GetOutputModules() const { return m_Outputs; }
-	void ConnectTo(ElfModule* Output)
+	struct PressResult
 	{
-		m_Outputs.push_back(Output);
-		Output->OnInputConnected(this);
-	}
-	const std::string& GetName() const { return m_Name; }
-	virtual void ResetState() {};
+		uint64_t lowPulses = 0;
+		uint64_t highPulses = 0;
+		uint64_t watchedSentHigh = 0; // Bit per watched module (in SetWatchedModules order) that sent at least one high pulse.
+		uint64_t watchedSentLow = 0;
+	};
 
-	template<class T>
-	const T* GetAs() const
+	uint32_t AddModule(const std::string& name, ModuleType type)
 	{
-		return static_cast<const T*>(this);
-	}
-protected:
-	ElfModule(const std::string& name, std::queue<SignalMessage>* signalQueue):m_Name(name), m_SignalQueue(signalQueue) {}
-	virtual ~ElfModule() {};
-
-	virtual void OnInputConnected(ElfModule* NewInput) { m_Inputs.push_back(NewInput); }
-	void QueueToAllOutputs(ElfSignal signal) 
-	{ 
-		for (ElfModule* output : m_Outputs)
+		std::unordered_map<std::string, uint32_t>::const_iterator itFind = m_nameToId.find(name);
+		if (itFind != m_nameToId.end())
 		{
-			m_SignalQueue->emplace(this, output, signal);
+			// Seen as a destination first, now we know what it is.
+			if (type != ModuleType::Sink)
+			{
+				m_types[itFind->second] = type;
+			}
+			return itFind->second;
 		}
+
+		const uint32_t id = (uint32_t)m_names.size();
+		m_nameToId.emplace(name, id);
+		m_names.push_back(name);
+		m_types.push_back(type);
+		return id;
 	}
-	void QueueSignal(ElfModule* module, ElfSignal signal) { m_SignalQueue->emplace(this, module, signal); }
-	
-	std::queue<SignalMessage>* m_SignalQueue;
-	std::vector<ElfModule*> m_Outputs;
-	std::vector<ElfModule*> m_Inputs;
-	std::string m_Name;
-};
 
-class FlipFlop : public ElfModule
-{
-public:
-	FlipFlop(const std::string& name, std::queue<SignalMessage>* signalQueue):ElfModule(name, signalQueue), m_State(false) {}
-	virtual void Execute(const SignalMessage& SignalMsg) override
+	void Connect(uint32_t source, uint32_t destination)
 	{
-		if (SignalMsg.Signal == ElfSignal::ES_High)
+		m_pendingEdges.emplace_back(source, destination);
+	}
+
+	// Flattens edges into CSR and hands out conjunction input bits. Must be called once all modules and connections are in.
+	void Compile()
+	{
+		const uint32_t moduleCount = GetModuleCount();
+		std::stable_sort(m_pendingEdges.begin(), m_pendingEdges.end(), [](const std::pair<uint32_t, uint32_t>& LHS, const std::pair<uint32_t, uint32_t>& RHS) { return LHS.first < RHS.first; });
+
+		m_outputOffsets.assign(moduleCount + 1, 0);
+		m_edgeTarget.clear();
+		m_edgeInputBit.clear();
+		m_conjunctionFullMask.assign(moduleCount, 0);
+		m_inputs.assign(moduleCount, std::vector<uint32_t>());
+
+		for (const std::pair<uint32_t, uint32_t>& edge : m_pendingEdges)
 		{
-			return;
+			++m_outputOffsets[edge.first + 1];
+			m_edgeTarget.push_back(edge.second);
+			m_inputs[edge.second].push_back(edge.first);
+
+			uint64_t inputBit = 0;
+			if (m_types[edge.second] == ModuleType::Conjunction)
+			{
+				const uint32_t inputIndex = (uint32_t)Bits::PopCount64(m_conjunctionFullMask[edge.second]);
+				assert(inputIndex < MAX_CONJUNCTION_INPUTS);
+				inputBit = 1ULL << inputIndex;
+				m_conjunctionFullMask[edge.second] |= inputBit;
+			}
+			m_edgeInputBit.push_back(inputBit);
 		}
 
-		m_State = !m_State;
+		for (uint32_t i = 0; i < moduleCount; ++i)
+		{
+			m_outputOffsets[i + 1] += m_outputOffsets[i];
+		}
 
-		QueueToAllOutputs(m_State ? ElfSignal::ES_High : ElfSignal::ES_Low);
+		m_watchIndex.assign(moduleCount, INVALID_MODULE);
+		// Indexing masks with size - 1, so round up to a power of 2.
+		size_t queueSize = 1024;
+		while (queueSize < m_edgeTarget.size() * 4)
+		{
+			queueSize *= 2;
+		}
+		m_pulses.assign(queueSize, 0);
+		m_broadcaster = GetModuleId("broadcaster");
+		Reset();
 	}
 
-	virtual void ResetState() override { m_State = false; }
-private:
-	bool m_State;
-};
+	void Reset()
+	{
+		m_flipFlopStates.assign((GetModuleCount() + 63) / 64, 0);
+		m_conjunctionMemory.assign(GetModuleCount(), 0);
+	}
 
-class Conjunction : public ElfModule
-{
-public:
-	Conjunction(const std::string& name, std::queue<SignalMessage>* signalQueue) :ElfModule(name, signalQueue) {}
-	virtual void Execute(const SignalMessage& SignalMsg) override
+	// Modules whose sent pulses get reported per press. Replaces any previous watch list.
+	void SetWatchedModules(const std::vector<uint32_t>& modules)
 	{
-		for (size_t i = 0; i < m_History.size(); ++i)
+		assert(modules.size() <= MAX_WATCHED_MODULES);
+		std::fill(m_watchIndex.begin(), m_watchIndex.end(), INVALID_MODULE);
+		for (uint32_t i = 0; i < (uint32_t)modules.size(); ++i)
 		{
-			if (m_History[i].Source == SignalMsg.Source)
-			{
-				m_History[i].Signal = SignalMsg.Signal;
-				break;
-			}
+			m_watchIndex[modules[i]] = i;
 		}
+	}
+
+	void PressButton(PressResult& outResult)
+	{
+		assert(m_broadcaster != INVALID_MODULE);
+		outResult = PressResult();
 
-		bool allHighSignals = true;
-		for (const SignalMessage& history : m_History)
+		// The button's pulse has no edge, so it's counted and delivered by hand.
+		++outResult.lowPulses;
+		m_head = 0;
+		m_tail = 0;
+		Emit(m_broadcaster, false, outResult);
+
+		while (m_head != m_tail)
 		{
-			if (history.Signal != ElfSignal::ES_High)
+			const uint32_t pulse = m_pulses[m_head & (m_pulses.size() - 1)];
+			++m_head;
+
+			const uint32_t edge = pulse >> 1;
+			const bool high = (pulse & 1) != 0;
+			const uint32_t module = m_edgeTarget[edge];
+
+			switch (m_types[module])
 			{
-				allHighSignals = false;
+				case ModuleType::FlipFlop:
+				{
+					if (!high)
+					{
+						uint64_t& word = m_flipFlopStates[module / 64];
+						word ^= 1ULL << (module % 64);
+						Emit(module, (word & (1ULL << (module % 64))) != 0, outResult);
+					}
+				}
+				break;
+				case ModuleType::Conjunction:
+				{
+					uint64_t& memory = m_conjunctionMemory[module];
+					memory = high ? (memory | m_edgeInputBit[edge]) : (memory & ~m_edgeInputBit[edge]);
+					Emit(module, memory != m_conjunctionFullMask[module], outResult);
+				}
 				break;
+				case ModuleType::Broadcaster:
+					Emit(module, high, outResult);
+					break;
+				case ModuleType::Sink:
+				default:
+					break;
 			}
 		}
-
-		QueueToAllOutputs(allHighSignals ? ElfSignal::ES_Low : ElfSignal::ES_High);
 	}
 
-	virtual void ResetState() override 
+	// Everything that changes between presses, flattened. Two presses starting from equal states play out identically.
+	void GetState(std::vector<uint64_t>& outState) const
 	{
-		for (SignalMessage& msg : m_History)
-		{
-			msg.Signal = ElfSignal::ES_Low;
-		}
+		outState.assign(m_flipFlopStates.begin(), m_flipFlopStates.end());
+		outState.insert(outState.end(), m_conjunctionMemory.begin(), m_conjunctionMemory.end());
 	}
-protected:
-	virtual void OnInputConnected(ElfModule* NewInput) { m_History.emplace_back(NewInput, this, ElfSignal::ES_Low); ElfModule::OnInputConnected(NewInput); }
-private:
-	std::vector<SignalMessage> m_History;
-};
 
-class Capture : public ElfModule
-{
-public:
-	Capture(const std::string& name, std::queue<SignalMessage>* signalQueue) :ElfModule(name, signalQueue) {}
-	virtual void Execute(const SignalMessage& SignalMsg) override
+	// Inverse of GetState.
+	void SetState(const std::vector<uint64_t>& state)
 	{
-		m_SignalCounts[static_cast<uint8_t>(SignalMsg.Signal)]++;
+		assert(state.size() == m_flipFlopStates.size() + m_conjunctionMemory.size());
+		std::copy(state.begin(), state.begin() + m_flipFlopStates.size(), m_flipFlopStates.begin());
+		std::copy(state.begin() + m_flipFlopStates.size(), state.end(), m_conjunctionMemory.begin());
 	}
 
-	uint32_t GetLowCount() const { return m_SignalCounts[0]; }
-	uint32_t GetHighCount() const { return m_SignalCounts[1]; }
+	// Copies just the kept modules (and connections between them) into outCircuit, which should be empty. Pulses leaving the
+	// kept set are dropped, which doesn't change anything inside it as long as nothing outside feeds back in.
+	void ExtractSubCircuit(const std::vector<uint8_t>& keep, CompiledCircuit& outCircuit) const
+	{
+		for (uint32_t module = 0; module < GetModuleCount(); ++module)
+		{
+			if (keep[module])
+			{
+				outCircuit.AddModule(m_names[module], m_types[module]);
+			}
+		}
 
-	virtual void ResetState()
+		for (uint32_t module = 0; module < GetModuleCount(); ++module)
+		{
+			for (uint32_t edge = m_outputOffsets[module]; edge < m_outputOffsets[module + 1]; ++edge)
+			{
+				if (keep[module] && keep[m_edgeTarget[edge]])
+				{
+					outCircuit.Connect(outCircuit.GetModuleId(m_names[module]), outCircuit.GetModuleId(m_names[m_edgeTarget[edge]]));
+				}
+			}
+		}
+
+		outCircuit.Compile();
+	}
+
+	uint32_t GetModuleCount() const { return (uint32_t)m_names.size(); }
+	uint32_t GetModuleId(const std::string& name) const
 	{
-		m_SignalCounts[0] = 0;
-		m_SignalCounts[1] = 0;
+		std::unordered_map<std::string, uint32_t>::const_iterator itFind = m_nameToId.find(name);
+		return itFind != m_nameToId.end() ? itFind->second : INVALID_MODULE;
 	}
-private:
-	uint32_t m_SignalCounts[2];
-};
+	const std::string& GetModuleName(uint32_t module) const { return m_names[module]; }
+	ModuleType GetModuleType(uint32_t module) const { return m_types[module]; }
+	const std::vector<uint32_t>& GetInputs(uint32_t module) const { return m_inputs[module]; }
 
-class Broadcaster : public ElfModule
-{
-public:
-	Broadcaster(const std::string& name, std::queue<SignalMessage>* signalQueue) :ElfModule(name, signalQueue) {}
-	virtual void Execute(const SignalMessage& SignalMsg) override
+private:
+	void Emit(uint32_t module, bool high, PressResult& outResult)
 	{
-		QueueToAllOutputs(SignalMsg.Signal);
+		const uint32_t begin = m_outputOffsets[module];
+		const uint32_t end = m_outputOffsets[module + 1];
+		if (high)
+		{
+			outResult.highPulses += end - begin;
+		}
+		else
+		{
+			outResult.lowPulses += end - begin;
+		}
+
+		if (m_watchIndex[module] != INVALID_MODULE)
+		{
+			(high ? outResult.watchedSentHigh : outResult.watchedSentLow) |= 1ULL << m_watchIndex[module];
+		}
+
+		for (uint32_t edge = begin; edge < end; ++edge)
+		{
+			if (m_tail - m_head == m_pulses.size())
+			{
+				GrowQueue();
+			}
+			m_pulses[m_tail & (m_pulses.size() - 1)] = (edge << 1) | (high ? 1 : 0);
+			++m_tail;
+		}
 	}
-};
 
-struct GetModuleByNamePred
-{
-	GetModuleByNamePred(const std::string& name) : m_Name(name){};
-	bool operator()(const ElfModule* module) const
+	// Only if a circuit ever has more pulses in flight than we guessed, unwraps into a buffer twice the size.
+	void GrowQueue()
 	{
-		return module->GetName() == m_Name;
+		assert((m_pulses.size() & (m_pulses.size() - 1)) == 0);
+		std::vector<uint32_t> grown(m_pulses.size() * 2);
+		for (size_t i = m_head; i != m_tail; ++i)
+		{
+			grown[i - m_head] = m_pulses[i & (m_pulses.size() - 1)];
+		}
+		m_tail -= m_head;
+		m_head = 0;
+		m_pulses.swap(grown);
 	}
-	std::string m_Name;
+
+	std::unordered_map<std::string, uint32_t> m_nameToId;
+	std::vector<std::string> m_names;
+	std::vector<ModuleType> m_types;
+	std::vector<std::pair<uint32_t, uint32_t>> m_pendingEdges;
+	std::vector<std::vector<uint32_t>> m_inputs;
+
+	std::vector<uint32_t> m_outputOffsets;
+	std::vector<uint32_t> m_edgeTarget;
+	std::vector<uint64_t> m_edgeInputBit; // Which memory bit this edge drives on a conjunction, 0 otherwise.
+	std::vector<uint64_t> m_conjunctionFullMask;
+	std::vector<uint32_t> m_watchIndex;
+	uint32_t m_broadcaster = INVALID_MODULE;
+
+	std::vector<uint64_t> m_flipFlopStates;
+	std::vector<uint64_t> m_conjunctionMemory;
+
+	std::vector<uint32_t> m_pulses; // Ring buffer of (edge << 1 | high), size is always a power of 2.
+	size_t m_head = 0;
+	size_t m_tail = 0;
 };
 
+constexpr uint32_t CompiledCircuit::INVALID_MODULE;
+
 class AdventDay : public AdventGUIInstance
 {
 public:
@@ -181,40 +309,27 @@ private:
 		std::string line;
 		std::vector<std::string> tokens;
 
-		// First pass, create all our modules.
 		while (!fileReader.IsEOF())
 		{
 			line = fileReader.ReadLine();
 			assert(line.size() != 0);
 			size_t spaceIdx = line.find(' ');
 			assert(spaceIdx != std::string::npos);
-			if (line[0] == '%' || line[0] == '&')
+
+			uint32_t sourceModule = CompiledCircuit::INVALID_MODULE;
+			if (line[0] == '%')
 			{
-				ElfModule* newModule = nullptr;
-				if (line[0] == '%')
-				{
-					newModule = new FlipFlop(line.substr(1, spaceIdx - 1), &m_SignalQueue);
-				}
-				else
-				{
-					newModule = new Conjunction(line.substr(1, spaceIdx - 1), &m_SignalQueue);
-				}
-				m_Modules.push_back(newModule);
+				sourceModule = m_Circuit.AddModule(line.substr(1, spaceIdx - 1), CompiledCircuit::ModuleType::FlipFlop);
+			}
+			else if (line[0] == '&')
+			{
+				sourceModule = m_Circuit.AddModule(line.substr(1, spaceIdx - 1), CompiledCircuit::ModuleType::Conjunction);
 			}
 			else
 			{
-				ElfModule* newModule = new Broadcaster(line.substr(0, spaceIdx), &m_SignalQueue);
-				m_Modules.push_back(newModule);
+				sourceModule = m_Circuit.AddModule(line.substr(0, spaceIdx), CompiledCircuit::ModuleType::Broadcaster);
 			}
-		}
 
-		fileReader.SeekAbsolute(0);
-		// Second pass, setup connections.
-		uint8_t sourceModuleIndex = 0;
-		while (!fileReader.IsEOF())
-		{
-			line = fileReader.ReadLine();
-			assert(line.size() != 0);
 			size_t arrowIdx = line.find('>');
 			assert(arrowIdx != std::string::npos);
 			std::string connections = line.substr(arrowIdx + 1);
@@ -222,150 +337,286 @@ private:
 
 			for (const std::string& tok : tokens)
 			{
-				int32_t destModuleIndex = Algorithm::find_index_of(m_Modules.begin(), m_Modules.end(), GetModuleByNamePred(tok));
-				if (destModuleIndex != -1)
-				{
-					m_Modules[sourceModuleIndex]->ConnectTo(m_Modules[destModuleIndex]);
-				}
-				else
-				{
-					ElfModule* newCapture = new Capture(tok, &m_SignalQueue);
-					m_Modules.push_back(newCapture);
-					m_Modules[sourceModuleIndex]->ConnectTo(newCapture);
-				}
+				m_Circuit.Connect(sourceModule, m_Circuit.AddModule(tok, CompiledCircuit::ModuleType::Sink));
 			}
-
-			++sourceModuleIndex;
 		}
-		
+
+		m_Circuit.Compile();
 	}
 
 	virtual void PartOne(const AdventGUIContext& context) override
 	{
 		// Part One
-		uint32_t LowSignalCounts = 0;
-		uint32_t HighSignalCounts = 0;
+		uint64_t LowSignalCounts = 0;
+		uint64_t HighSignalCounts = 0;
 
+		CompiledCircuit::PressResult press;
 		for (uint32_t i = 0; i < 1000; ++i)
 		{
-			// Start Message
-			int32_t destModuleIndex = Algorithm::find_index_of(m_Modules.begin(), m_Modules.end(), GetModuleByNamePred("broadcaster"));
-			assert(destModuleIndex != -1);
+			m_Circuit.PressButton(press);
+			LowSignalCounts += press.lowPulses;
+			HighSignalCounts += press.highPulses;
+		}
 
-			m_SignalQueue.emplace(nullptr, m_Modules[destModuleIndex], ElfSignal::ES_Low);
-			SignalMessage currentSignal(nullptr, nullptr, ElfSignal::ES_Low);
-			while (!m_SignalQueue.empty())
-			{
-				currentSignal = m_SignalQueue.front();
-				m_SignalQueue.pop();
+		Log("Total Pulses: %llu", LowSignalCounts * HighSignalCounts);
 
-				if (currentSignal.Signal == ElfSignal::ES_Low)
-				{
-					++LowSignalCounts;
-				}
-				else
-				{
-					++HighSignalCounts;
-				}
+		// Done.
+		AdventGUIInstance::PartOne(context);
+	}
+
+	// When one feeder of rx's conjunction sends a high pulse. Presses are 1 based. The sub-circuit's state after press tail
+	// repeats every period presses, so anything past tail is periodic too.
+	struct FeederCycle
+	{
+		uint32_t tail = 0;
+		uint32_t period = 0;
+		std::vector<uint32_t> tailPresses; // Presses in [1, tail] that fire.
+		std::vector<uint32_t> cycleResidues; // (press - tail - 1) % period for presses past tail that fire.
+	};
+
+	bool FiresOnPress(const FeederCycle& cycle, uint64_t press) const
+	{
+		if (press <= cycle.tail)
+		{
+			return std::find(cycle.tailPresses.begin(), cycle.tailPresses.end(), (uint32_t)press) != cycle.tailPresses.end();
+		}
+		const uint32_t residue = (uint32_t)((press - cycle.tail - 1) % cycle.period);
+		return std::find(cycle.cycleResidues.begin(), cycle.cycleResidues.end(), residue) != cycle.cycleResidues.end();
+	}
+
+	// Presses the isolated sub-circuit until its whole state repeats, then replays the first tail + period presses noting which
+	// ones made the feeder send high. Only a fingerprint per press is kept while searching.
+	bool FindFeederCycle(CompiledCircuit& subCircuit, uint32_t feeder, FeederCycle& outCycle) const
+	{
+		subCircuit.Reset();
+		subCircuit.SetWatchedModules(std::vector<uint32_t>(1, feeder));
 
-				currentSignal.Destination->Execute(currentSignal);
+		CompiledCircuit::PressResult press;
+		auto step = [&subCircuit, &press](std::vector<uint64_t>& state)
+		{
+			subCircuit.SetState(state);
+			subCircuit.PressButton(press);
+			subCircuit.GetState(state);
+		};
+		auto hash = [](const std::vector<uint64_t>& state)
+		{
+			uint64_t hash = 0;
+			for (uint64_t word : state)
+			{
+				hash = Hash::HashCombineU64(hash, word);
 			}
+			return hash;
+		};
+
+		std::vector<uint64_t> state;
+		subCircuit.GetState(state);
+		Cycle::Result cycle;
+		if (!Cycle::FindWithFingerprints(state, step, hash, cycle, MAX_CYCLE_SEARCH_PRESSES))
+		{
+			return false;
 		}
 
-		Log("Total Pulses: %llu", (uint64_t)LowSignalCounts * (uint64_t)HighSignalCounts);
+		outCycle.tail = (uint32_t)cycle.mu;
+		outCycle.period = (uint32_t)cycle.lambda;
+		subCircuit.Reset();
+		for (uint32_t pressIndex = 1; pressIndex <= outCycle.tail + outCycle.period; ++pressIndex)
+		{
+			subCircuit.PressButton(press);
+			if (!press.watchedSentHigh)
+			{
+				continue;
+			}
 
-		// Done.
-		AdventGUIInstance::PartOne(context);
+			if (pressIndex <= outCycle.tail)
+			{
+				outCycle.tailPresses.push_back(pressIndex);
+			}
+			else
+			{
+				outCycle.cycleResidues.push_back(pressIndex - outCycle.tail - 1);
+			}
+		}
+		return true;
 	}
 
-	virtual void PartTwo(const AdventGUIContext& context) override
-	{	
-		// Part Two
-		for (ElfModule* module : m_Modules)
+	// Smallest press where every feeder fires at once. Tails get checked directly, past them it's a CRT over every combination of
+	// firing residues. 0 if there's no such press (or it doesn't fit in 64 bits).
+	uint64_t FindFirstCommonPress(const std::vector<FeederCycle>& cycles) const
+	{
+		uint32_t longestTail = 0;
+		for (const FeederCycle& cycle : cycles)
+		{
+			longestTail = std::max(longestTail, cycle.tail);
+		}
+
+		for (uint64_t press = 1; press <= longestTail; ++press)
 		{
-			module->ResetState();
+			bool allFire = true;
+			for (const FeederCycle& cycle : cycles)
+			{
+				allFire &= FiresOnPress(cycle, press);
+			}
+
+			if (allFire)
+			{
+				return press;
+			}
 		}
 
-		int32_t rxModuleIndex = Algorithm::find_index_of(m_Modules.begin(), m_Modules.end(), GetModuleByNamePred("rx"));
-		assert(rxModuleIndex != -1);
+		uint64_t best = 0;
+		std::vector<uint32_t> choice(cycles.size(), 0);
+		while (true)
+		{
+			uint64_t a = 0;
+			uint64_t m = 1;
+			bool consistent = true;
+			for (size_t i = 0; i < cycles.size() && consistent; ++i)
+			{
+				const FeederCycle& cycle = cycles[i];
+				if (cycle.cycleResidues.empty())
+				{
+					return best; // Never fires again.
+				}
+				consistent = Math::CombineCongruences(a, m, cycle.tail + 1 + cycle.cycleResidues[choice[i]], cycle.period, a, m);
+			}
 
-		const Capture* rxModule = m_Modules[rxModuleIndex]->GetAs<Capture>();
-		uint32_t totalButtonPresses = 0;
+			if (consistent)
+			{
+				// First press past every tail in this residue class.
+				uint64_t press = a;
+				if (press <= longestTail)
+				{
+					press += ((longestTail + 1 - press + m - 1) / m) * m;
+				}
+				best = best == 0 ? press : std::min(best, press);
+			}
+
+			// Next combination.
+			size_t digit = 0;
+			while (digit < cycles.size() && ++choice[digit] == cycles[digit].cycleResidues.size())
+			{
+				choice[digit++] = 0;
+			}
+
+			if (digit == cycles.size())
+			{
+				break;
+			}
+		}
 
-		uint32_t lastUpdateValueForConj[4] = { 0 };
-		uint32_t buttonPressesForConj[4] = { 0 };
-		const char* conjModuleNames[] = {"kd", "zf", "vg", "gs"}; // Found by looking at the RX module inputs (1 conj, which has inputs from 4 conj, these guys).
-		bool stableNumbers[4] = { false }; 
-		const Conjunction* watchModules[4] = { nullptr };
+		return best;
+	}
 
-		for (uint32_t i = 0; i < ARRAY_SIZE(conjModuleNames); ++i)
+	// rx only ever hears from one conjunction, which goes low once all of its feeders have sent high in the same press. Each
+	// feeder is normally driven by its own independent sub-circuit hanging off the broadcaster, so those get split out and run
+	// on their own until they cycle.
+	bool AnalyzeFeeders(std::vector<FeederCycle>& outCycles) const
+	{
+		const uint32_t rx = m_Circuit.GetModuleId("rx");
+		const uint32_t broadcaster = m_Circuit.GetModuleId("broadcaster");
+		if (rx == CompiledCircuit::INVALID_MODULE || broadcaster == CompiledCircuit::INVALID_MODULE || m_Circuit.GetInputs(rx).size() != 1)
 		{
-			int32_t watchIdx = Algorithm::find_index_of(m_Modules.begin(), m_Modules.end(), GetModuleByNamePred(conjModuleNames[i]));
-			assert(watchIdx != -1);
-			watchModules[i] = m_Modules[watchIdx]->GetAs<Conjunction>();
+			return false;
 		}
 
-		uint32_t totalSignalsSent = 0;
-		bool canBreak = false;
-		while(!canBreak)
+		const uint32_t gate = m_Circuit.GetInputs(rx)[0];
+		if (m_Circuit.GetModuleType(gate) != CompiledCircuit::ModuleType::Conjunction)
 		{
-			// Start Message
-			int32_t destModuleIndex = Algorithm::find_index_of(m_Modules.begin(), m_Modules.end(), GetModuleByNamePred("broadcaster"));
-			assert(destModuleIndex != -1);
+			return false;
+		}
 
-			m_SignalQueue.emplace(nullptr, m_Modules[destModuleIndex], ElfSignal::ES_Low);
-			SignalMessage currentSignal(nullptr, nullptr, ElfSignal::ES_Low);
+		// Walk back from each feeder. Cones have to stay clear of the gate and of each other, the broadcaster is shared.
+		const std::vector<uint32_t>& feeders = m_Circuit.GetInputs(gate);
+		std::vector<uint32_t> owner(m_Circuit.GetModuleCount(), CompiledCircuit::INVALID_MODULE);
+		std::vector<std::vector<uint8_t>> cones(feeders.size(), std::vector<uint8_t>(m_Circuit.GetModuleCount(), 0));
+		for (uint32_t i = 0; i < (uint32_t)feeders.size(); ++i)
+		{
+			std::vector<uint32_t> stack(1, feeders[i]);
+			cones[i][feeders[i]] = 1;
+			while (!stack.empty())
+			{
+				const uint32_t module = stack.back();
+				stack.pop_back();
 
-			totalSignalsSent = 0;
+				if (module == gate || (owner[module] != CompiledCircuit::INVALID_MODULE && owner[module] != i))
+				{
+					return false;
+				}
 
-			while (!m_SignalQueue.empty())
-			{
-				currentSignal = m_SignalQueue.front();
-				m_SignalQueue.pop();
-				++totalSignalsSent;
+				if (module == broadcaster)
+				{
+					continue;
+				}
+				owner[module] = i;
 
-				for (uint32_t i = 0; i < ARRAY_SIZE(watchModules); ++i)
+				for (uint32_t input : m_Circuit.GetInputs(module))
 				{
-					// Update the conjunction modules we're watching.
-					if (currentSignal.Source == watchModules[i] && currentSignal.Signal == ElfSignal::ES_High)
+					if (!cones[i][input])
 					{
-						Log("Conjunction Module %s sent a High signal on press [%u] step [%u]", currentSignal.Source->GetName().c_str(), totalButtonPresses, totalSignalsSent);
-
-						uint32_t oldValue = buttonPressesForConj[i];
-						buttonPressesForConj[i] = totalButtonPresses - lastUpdateValueForConj[i];
-						stableNumbers[i] = oldValue == buttonPressesForConj[i];
-						lastUpdateValueForConj[i] = totalButtonPresses;
-
-						// If we have stable numbers for all 4, we can stop.
-						canBreak = true;
-						for (uint32_t j = 0; j < 4; ++j)
-						{
-							canBreak &= stableNumbers[i];
-						}
+						cones[i][input] = 1;
+						stack.push_back(input);
 					}
 				}
-
-				currentSignal.Destination->Execute(currentSignal);
 			}
+		}
 
-			++totalButtonPresses;
+		outCycles.assign(feeders.size(), FeederCycle());
+		std::vector<uint8_t> found(feeders.size(), 0);
+		Parallel::ForEach(feeders.size(), [&](uint32_t, size_t i)
+		{
+			CompiledCircuit subCircuit;
+			m_Circuit.ExtractSubCircuit(cones[i], subCircuit);
+			found[i] = FindFeederCycle(subCircuit, subCircuit.GetModuleId(m_Circuit.GetModuleName(feeders[i])), outCycles[i]) ? 1 : 0;
+		});
+
+		for (uint32_t i = 0; i < (uint32_t)feeders.size(); ++i)
+		{
+			if (!found[i])
+			{
+				return false;
+			}
+			Log("Feeder %s: tail [%u] period [%u] firing residues [%zd]", m_Circuit.GetModuleName(feeders[i]).c_str(), outCycles[i].tail, outCycles[i].period, outCycles[i].cycleResidues.size());
 		}
+		return true;
+	}
 
-		Log("Stable after %u presses. Counts [%u] [%u] [%u] [%u].", totalButtonPresses, buttonPressesForConj[0], buttonPressesForConj[1], buttonPressesForConj[2], buttonPressesForConj[3]);
+	virtual void PartTwo(const AdventGUIContext& context) override
+	{	
+		// Part Two
+		std::vector<FeederCycle> cycles;
+		if (AnalyzeFeeders(cycles))
+		{
+			Log("Total Button Presses: %llu", FindFirstCommonPress(cycles));
+		}
+		else
+		{
+			// Doesn't look like the usual layout, just push the button until rx gets its low pulse.
+			Log("Couldn't split rx's inputs into independent sub-circuits, simulating the whole thing.");
+			m_Circuit.Reset();
 
-		uint64_t lcmValueA = Math::LCM(buttonPressesForConj[0], buttonPressesForConj[1]);
-		uint64_t lcmValueB = Math::LCM(buttonPressesForConj[2], buttonPressesForConj[3]);
+			const uint32_t rx = m_Circuit.GetModuleId("rx");
+			assert(rx != CompiledCircuit::INVALID_MODULE);
+			m_Circuit.SetWatchedModules(m_Circuit.GetInputs(rx));
 
-		uint64_t lcm = Math::LCM(lcmValueA, lcmValueB);
+			CompiledCircuit::PressResult press;
+			uint64_t totalButtonPresses = 0;
+			do
+			{
+				m_Circuit.PressButton(press);
+				++totalButtonPresses;
+			} while (press.watchedSentLow == 0 && totalButtonPresses < MAX_BRUTE_FORCE_PRESSES);
 
-		Log("Total Button Presses: %llu", lcm);
+			Log("Total Button Presses: %llu%s", totalButtonPresses, press.watchedSentLow ? "" : " (gave up)");
+		}
 
 		// Done.
 		AdventGUIInstance::PartTwo(context);
 	}
 
-	std::queue<SignalMessage> m_SignalQueue;
-	std::vector<ElfModule*> m_Modules;
+	static constexpr uint32_t MAX_CYCLE_SEARCH_PRESSES = 1U << 20;
+	static constexpr uint64_t MAX_BRUTE_FORCE_PRESSES = 1ULL << 26;
+
+	CompiledCircuit m_Circuit;
 };
 
 int main()
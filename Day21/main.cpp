@@ -3,166 +3,418 @@
 
 #include "AdventGUI/AdventGUI.h"
 
-#include "ACUtils/Hash.h"
+#include "ACUtils/Bit.h"
 #include "ACUtils/IntVec.h"
 #include "ACUtils/Math.h"
 #include "ACUtils/StringUtil.h"
 #include <vector>
 #include <cinttypes>
-#include <queue>
-#include <unordered_set>
 
-struct WalkState
-{
-	WalkState(const IntVec2& _pos, uint32_t _steps) : Pos(_pos), StepsRemaining(_steps) {};
-	IntVec2 Pos;
-	uint32_t StepsRemaining;
-	uint64_t GetHash() const { return Pos.x | Pos.y << 12 | StepsRemaining << 24UL; }
-	bool operator==(const WalkState& RHS) const { return GetHash() == RHS.GetHash(); }
-};
-
-ENABLE_STL_HASH(WalkState, GetHash);
-
-class AdventDay : public AdventGUIInstance
+// Plot reachability for the step counter.
+//
+// Small step counts are stepped directly: the whole frontier lives in a bitboard and each step is a N/S/E/W shift of
+// every row AND'd with the garden mask (optionally over a tiling of the map, with per tile-copy counts).
+//
+// Infinite tilings are derived from the BFS distance field of a single tile copy from its 9 entry points (the start,
+// the four edge midpoints in line with the start and the four corners). With open borders and a clear start row / column,
+// every copy is first entered through one of those points, so a copy's reachable count is just a lookup into the
+// matching entry's cumulative parity histogram.
+class GardenWalker
 {
 public:
-	AdventDay(const AdventGUIParams& params)
-		: AdventGUIInstance(params)
-	{};
-private:
-	virtual void ParseInput(FileStreamReader& fileReader) override
+	GardenWalker(const std::vector<char>& map, uint32_t mapWidth, uint32_t mapHeight, const IntVec2& startPos)
+	: m_map(map),
+	m_mapWidth(mapWidth),
+	m_mapHeight(mapHeight),
+	m_startPos(startPos)
 	{
-		// Parse Input. Input never changes between parts of a problem.
-		std::string line;
-		std::vector<std::string> tokens;
+		BuildEntryFields();
+	}
 
-		while (!fileReader.IsEOF())
+	// Exact number of plots reachable in exactly numSteps steps on a (2 * tileRadius + 1)^2 tiling of the map, with the start in the center copy.
+	// If outCopyCounts is provided, it's filled with the count for each tile copy (row major).
+	uint64_t StepFrontier(uint32_t numSteps, uint32_t tileRadius, std::vector<uint64_t>* outCopyCounts = nullptr) const
+	{
+		const uint32_t copiesPerSide = tileRadius * 2 + 1;
+		const uint32_t boardWidth = m_mapWidth * copiesPerSide;
+		const uint32_t boardHeight = m_mapHeight * copiesPerSide;
+		const uint32_t wordsPerRow = (boardWidth + 63) / 64;
+
+		// Padding row above and below so N/S shifts don't need bounds checks.
+		std::vector<uint64_t> garden((boardHeight + 2) * wordsPerRow, 0);
+		for (uint32_t y = 0; y < boardHeight; ++y)
 		{
-			line = fileReader.ReadLine();
-			if (m_MapWidth == 0)
+			uint64_t* row = &garden[(y + 1) * wordsPerRow];
+			for (uint32_t x = 0; x < boardWidth; ++x)
 			{
-				m_MapWidth = (uint32_t)line.size();
+				if (m_map[(y % m_mapHeight) * m_mapWidth + (x % m_mapWidth)] != '#')
+				{
+					row[x / 64] |= 1ULL << (x % 64);
+				}
 			}
-			assert(m_MapWidth == line.size());
+		}
 
-			size_t startPosIdx = line.find('S');
-			if (startPosIdx != std::string::npos)
+		std::vector<uint64_t> frontier(garden.size(), 0);
+		std::vector<uint64_t> nextFrontier(garden.size(), 0);
+		const uint32_t startX = m_startPos.x + tileRadius * m_mapWidth;
+		const uint32_t startY = m_startPos.y + tileRadius * m_mapHeight;
+		frontier[(startY + 1) * wordsPerRow + startX / 64] |= 1ULL << (startX % 64);
+
+		for (uint32_t step = 0; step < numSteps; ++step)
+		{
+			for (uint32_t y = 1; y <= boardHeight; ++y)
 			{
-				m_StartPos = IntVec2((uint32_t)startPosIdx, (uint32_t)m_Map.size() / m_MapWidth);
-				line[startPosIdx] = '.';
+				const uint64_t* above = &frontier[(y - 1) * wordsPerRow];
+				const uint64_t* current = &frontier[y * wordsPerRow];
+				const uint64_t* below = &frontier[(y + 1) * wordsPerRow];
+				const uint64_t* mask = &garden[y * wordsPerRow];
+				uint64_t* out = &nextFrontier[y * wordsPerRow];
+				for (uint32_t w = 0; w < wordsPerRow; ++w)
+				{
+					const uint64_t east = (current[w] << 1) | (w > 0 ? current[w - 1] >> 63 : 0);
+					const uint64_t west = (current[w] >> 1) | (w + 1 < wordsPerRow ? current[w + 1] << 63 : 0);
+					out[w] = (above[w] | below[w] | east | west) & mask[w];
+				}
 			}
-			m_Map.insert(m_Map.end(), line.begin(), line.end());
+			std::swap(frontier, nextFrontier);
 		}
 
-		m_MapHeight = (uint32_t)m_Map.size() / m_MapWidth;
+		if (outCopyCounts)
+		{
+			outCopyCounts->assign(copiesPerSide * copiesPerSide, 0);
+		}
+
+		uint64_t total = 0;
+		for (uint32_t y = 0; y < boardHeight; ++y)
+		{
+			const uint64_t* row = &frontier[(y + 1) * wordsPerRow];
+			for (uint32_t copyX = 0; copyX < copiesPerSide; ++copyX)
+			{
+				const uint64_t count = CountBitsInRange(row, copyX * m_mapWidth, (copyX + 1) * m_mapWidth);
+				total += count;
+				if (outCopyCounts)
+				{
+					(*outCopyCounts)[(y / m_mapHeight) * copiesPerSide + copyX] += count;
+				}
+			}
+		}
+
+		return total;
 	}
 
-	bool IsValidPos(const IntVec2& pos) const
+	// The entry point model only holds if the borders are open and the start has a clear line to each edge.
+	bool CanSolveInfinite() const
 	{
-		if (pos.x < 0 || pos.y < 0 || (uint32_t)pos.x >= m_MapWidth || (uint32_t)pos.y >= m_MapHeight)
+		for (uint32_t x = 0; x < m_mapWidth; ++x)
 		{
-			return false;
+			if (IsRock(x, 0) || IsRock(x, m_mapHeight - 1) || IsRock(x, m_startPos.y))
+			{
+				return false;
+			}
 		}
 
-		return m_Map[pos.y * m_MapWidth + pos.x] == '.';
+		for (uint32_t y = 0; y < m_mapHeight; ++y)
+		{
+			if (IsRock(0, y) || IsRock(m_mapWidth - 1, y) || IsRock(m_startPos.x, y))
+			{
+				return false;
+			}
+		}
+
+		return true;
 	}
 
+	// Plots reachable in exactly numSteps steps on an infinitely tiled map.
+	uint64_t CountInfinite(uint64_t numSteps) const
+	{
+		assert(CanSolveInfinite());
+
+		const int64_t steps = (int64_t)numSteps;
+		const int64_t width = m_mapWidth;
+		const int64_t height = m_mapHeight;
+
+		// Steps needed to enter the neighboring copy on each side.
+		const int64_t toEast = width - m_startPos.x;
+		const int64_t toWest = m_startPos.x + 1;
+		const int64_t toSouth = height - m_startPos.y;
+		const int64_t toNorth = m_startPos.y + 1;
+
+		uint64_t total = CountWithin(Entry_Start, steps);
+
+		// Copies in line with the start are entered at the edge midpoint facing us.
+		total += SumAlongLine(Entry_WestMid, steps - toEast, width);
+		total += SumAlongLine(Entry_EastMid, steps - toWest, width);
+		total += SumAlongLine(Entry_NorthMid, steps - toSouth, height);
+		total += SumAlongLine(Entry_SouthMid, steps - toNorth, height);
+
+		// Diagonal quadrants are entered at the nearest corner.
+		total += SumQuadrant(Entry_SouthWest, steps - toEast - toNorth);
+		total += SumQuadrant(Entry_NorthWest, steps - toEast - toSouth);
+		total += SumQuadrant(Entry_NorthEast, steps - toWest - toSouth);
+		total += SumQuadrant(Entry_SouthEast, steps - toWest - toNorth);
 
-	bool IsValidPosInf(const IntVec2& pos) const
+		return total;
+	}
+
+private:
+	enum EntryPoint : uint32_t
 	{
-		// Handle wrap around
-		int yTest = pos.y;
-		int xTest = pos.x;
+		Entry_Start = 0,
+		Entry_WestMid,
+		Entry_EastMid,
+		Entry_NorthMid,
+		Entry_SouthMid,
+		Entry_NorthWest,
+		Entry_NorthEast,
+		Entry_SouthWest,
+		Entry_SouthEast,
+		Entry_Count
+	};
+
+	static constexpr uint32_t UNREACHED = ~0U;
+
+	bool IsRock(uint32_t x, uint32_t y) const { return m_map[y * m_mapWidth + x] == '#'; }
+
+	static uint64_t CountBitsInRange(const uint64_t* row, uint32_t start, uint32_t end)
+	{
+		uint64_t total = 0;
+		while (start < end)
+		{
+			const uint32_t bit = start % 64;
+			const uint32_t bitsInWord = std::min(64 - bit, end - start);
+			total += Bits::PopCount64((row[start / 64] >> bit) & Bits::CreateBitMask64(0, bitsInWord));
+			start += bitsInWord;
+		}
+		return total;
+	}
 
-		if (yTest < 0)
+	void BuildEntryFields()
+	{
+		const uint32_t lastX = m_mapWidth - 1;
+		const uint32_t lastY = m_mapHeight - 1;
+		const IntVec2 entries[Entry_Count] =
+		{
+			m_startPos,
+			IntVec2(0, m_startPos.y), IntVec2(lastX, m_startPos.y), IntVec2(m_startPos.x, 0), IntVec2(m_startPos.x, lastY),
+			IntVec2(0, 0), IntVec2(lastX, 0), IntVec2(0, lastY), IntVec2(lastX, lastY)
+		};
+
+		std::vector<uint32_t> distances;
+		std::vector<uint32_t> queue;
+		for (uint32_t entry = 0; entry < Entry_Count; ++entry)
 		{
-			yTest = m_MapHeight - (abs(yTest) % m_MapHeight);
+			BuildDistanceField(entries[entry], distances, queue);
+
+			// m_parityCounts[d] = number of plots at distance d, d - 2, d - 4, ... which is everything reachable in exactly d steps.
+			uint32_t maxDistance = 0;
+			for (uint32_t distance : distances)
+			{
+				if (distance != UNREACHED)
+				{
+					maxDistance = std::max(maxDistance, distance);
+				}
+			}
+
+			std::vector<uint64_t>& cumulative = m_parityCounts[entry];
+			cumulative.assign(maxDistance + 1, 0);
+			for (uint32_t distance : distances)
+			{
+				if (distance != UNREACHED)
+				{
+					++cumulative[distance];
+				}
+			}
+
+			for (uint32_t d = 2; d <= maxDistance; ++d)
+			{
+				cumulative[d] += cumulative[d - 2];
+			}
 		}
+	}
 
-		if (xTest < 0)
+	void BuildDistanceField(const IntVec2& source, std::vector<uint32_t>& outDistances, std::vector<uint32_t>& queue) const
+	{
+		outDistances.assign(m_map.size(), UNREACHED);
+		queue.clear();
+		if (IsRock(source.x, source.y))
 		{
-			xTest = m_MapWidth - (abs(xTest) % m_MapWidth);
+			return;
 		}
 
-		yTest = (yTest + m_MapHeight) % m_MapHeight;
-		xTest = (xTest + m_MapWidth) % m_MapWidth;
+		const uint32_t sourceIndex = source.y * m_mapWidth + source.x;
+		outDistances[sourceIndex] = 0;
+		queue.push_back(sourceIndex);
+		for (size_t head = 0; head < queue.size(); ++head)
+		{
+			const uint32_t index = queue[head];
+			const uint32_t x = index % m_mapWidth;
+			const uint32_t y = index / m_mapWidth;
+			const uint32_t nextDistance = outDistances[index] + 1;
 
-		return m_Map[yTest * m_MapWidth + xTest] == '.';
+			auto visit = [&](uint32_t neighbor)
+			{
+				if (m_map[neighbor] != '#' && outDistances[neighbor] == UNREACHED)
+				{
+					outDistances[neighbor] = nextDistance;
+					queue.push_back(neighbor);
+				}
+			};
+
+			if (x > 0) visit(index - 1);
+			if (x + 1 < m_mapWidth) visit(index + 1);
+			if (y > 0) visit(index - m_mapWidth);
+			if (y + 1 < m_mapHeight) visit(index + m_mapWidth);
+		}
 	}
 
-	virtual void PartOne(const AdventGUIContext& context) override
+	// Plots in a copy entered via entry that are reachable with exactly stepsLeft steps remaining on arrival.
+	uint64_t CountWithin(uint32_t entry, int64_t stepsLeft) const
 	{
-		// Part One
-		uint64_t totalSteps = SolveForSteps(64);
+		if (stepsLeft < 0)
+		{
+			return 0;
+		}
 
-		Log("Total Reachable Steps: %zd", totalSteps);
+		const std::vector<uint64_t>& cumulative = m_parityCounts[entry];
+		const int64_t maxDistance = (int64_t)cumulative.size() - 1;
+		if (stepsLeft > maxDistance)
+		{
+			// Everything with a matching parity is reachable.
+			stepsLeft = maxDistance - ((maxDistance - stepsLeft) & 1);
+		}
 
-		// Done.
-		AdventGUIInstance::PartOne(context);
+		return stepsLeft < 0 ? 0 : cumulative[(size_t)stepsLeft];
 	}
 
-	uint64_t SolveForSteps(uint32_t numSteps) const
+	// Sum of CountWithin(entry, stepsLeft - i * stride) for every i >= 0 that leaves us with steps to spare.
+	// Copies that are fully covered are counted in bulk, we only walk the partially covered copies at the far end.
+	uint64_t SumAlongLine(uint32_t entry, int64_t stepsLeft, int64_t stride) const
 	{
-		std::unordered_set<IntVec2> outValues;
-		std::unordered_set<IntVec2> cache;
-		std::queue<WalkState> queue;
+		if (stepsLeft < 0)
+		{
+			return 0;
+		}
 
-		queue.emplace(m_StartPos, numSteps);
-		cache.insert(m_StartPos);
+		const int64_t maxDistance = (int64_t)m_parityCounts[entry].size() - 1;
+		const int64_t fullCopies = stepsLeft >= maxDistance ? (stepsLeft - maxDistance) / stride + 1 : 0;
 
-		WalkState currentState(m_StartPos, 0);
-		while (!queue.empty())
+		uint64_t total = 0;
+		if (fullCopies > 0)
 		{
-			currentState = queue.front();
-			queue.pop();
-
-			if (currentState.StepsRemaining % 2 == 0)
+			// stepsLeft is past maxDistance here, so these are the full parity counts.
+			const uint64_t sameParity = CountWithin(entry, stepsLeft);
+			const uint64_t otherParity = CountWithin(entry, stepsLeft + 1);
+			if (stride % 2 == 0)
+			{
+				total += (uint64_t)fullCopies * sameParity;
+			}
+			else
 			{
-				// Can always reach even.
-				outValues.insert(currentState.Pos);
+				// Parity flips with every copy.
+				total += (uint64_t)((fullCopies + 1) / 2) * sameParity + (uint64_t)(fullCopies / 2) * otherParity;
 			}
+		}
+
+		for (int64_t remaining = stepsLeft - fullCopies * stride; remaining >= 0; remaining -= stride)
+		{
+			total += CountWithin(entry, remaining);
+		}
+
+		return total;
+	}
+
+	// Every copy (i, j) with i, j >= 0 of a diagonal quadrant, stepsLeft is what remains on entering the nearest one.
+	uint64_t SumQuadrant(uint32_t entry, int64_t stepsLeft) const
+	{
+		uint64_t total = 0;
+		for (; stepsLeft >= 0; stepsLeft -= m_mapWidth)
+		{
+			total += SumAlongLine(entry, stepsLeft, m_mapHeight);
+		}
+		return total;
+	}
+
+	const std::vector<char>& m_map;
+	uint32_t m_mapWidth;
+	uint32_t m_mapHeight;
+	IntVec2 m_startPos;
+	std::vector<uint64_t> m_parityCounts[Entry_Count];
+};
 
-			if (currentState.StepsRemaining == 0)
+constexpr uint32_t GardenWalker::UNREACHED;
+
+class AdventDay : public AdventGUIInstance
+{
+public:
+	AdventDay(const AdventGUIParams& params)
+		: AdventGUIInstance(params),
+		m_MapWidth(0),
+		m_MapHeight(0)
+	{};
+private:
+	virtual void ParseInput(FileStreamReader& fileReader) override
+	{
+		// Parse Input. Input never changes between parts of a problem.
+		std::string line;
+		std::vector<std::string> tokens;
+
+		while (!fileReader.IsEOF())
+		{
+			line = fileReader.ReadLine();
+			if (m_MapWidth == 0)
 			{
-				continue;
+				m_MapWidth = (uint32_t)line.size();
 			}
+			assert(m_MapWidth == line.size());
 
-			static const IntVec2 offsets[] = { {1, 0}, {0, 1}, {-1, 0}, {0, -1} };
-			for (const IntVec2 offset : offsets)
+			size_t startPosIdx = line.find('S');
+			if (startPosIdx != std::string::npos)
 			{
-				if (IsValidPosInf(currentState.Pos + offset) && cache.find(currentState.Pos + offset) == cache.end())
-				{
-					queue.emplace(currentState.Pos + offset, currentState.StepsRemaining - 1);
-					cache.insert(currentState.Pos + offset);
-				}
+				m_StartPos = IntVec2((uint32_t)startPosIdx, (uint32_t)m_Map.size() / m_MapWidth);
+				line[startPosIdx] = '.';
 			}
+			m_Map.insert(m_Map.end(), line.begin(), line.end());
 		}
 
-		return outValues.size();
+		m_MapHeight = (uint32_t)m_Map.size() / m_MapWidth;
+	}
+
+	virtual void PartOne(const AdventGUIContext& context) override
+	{
+		// Part One
+		GardenWalker walker(m_Map, m_MapWidth, m_MapHeight, m_StartPos);
+		uint64_t totalSteps = walker.StepFrontier(PART_ONE_STEPS, 0);
+
+		Log("Total Reachable Steps: %" PRIu64, totalSteps);
+
+		// Done.
+		AdventGUIInstance::PartOne(context);
 	}
 
+	static constexpr uint32_t PART_ONE_STEPS = 64;
 	static constexpr uint64_t STEP_LIMIT = 26501365;
-	static constexpr uint64_t TEST_MAP_SIZE = 131;
-	static constexpr uint64_t REMAINDER_IN_LOOP = STEP_LIMIT % TEST_MAP_SIZE;
 
 	virtual void PartTwo(const AdventGUIContext& context) override
 	{	
 		// Part Two
-		std::vector<int64_t> quadFormulaParams;
-
-		for (size_t i = 0; i < 3; ++i)
+		GardenWalker walker(m_Map, m_MapWidth, m_MapHeight, m_StartPos);
+		if (!walker.CanSolveInfinite())
 		{
-			quadFormulaParams.push_back((int64_t)SolveForSteps(i * m_MapWidth + REMAINDER_IN_LOOP));
+			Log("Map needs open borders and a clear row / column through the start to solve an infinite tiling.");
+			AdventGUIInstance::PartTwo(context);
+			return;
 		}
 
-		int64_t p0 = quadFormulaParams[0];
-		int64_t p1 = quadFormulaParams[1] - quadFormulaParams[0];
-		int64_t p2 = quadFormulaParams[2] - quadFormulaParams[1];
-		int64_t iters = (int64_t)(STEP_LIMIT - REMAINDER_IN_LOOP) / (int64_t)m_MapWidth;
+		// Sanity check the entry point model against stepping the frontier over a 5x5 tiling. Stays within the tightest
+		// clearance on either axis so the walk can't run off the tiling.
+		const uint32_t startClearance = (uint32_t)std::min(std::min(m_StartPos.x, m_StartPos.y), std::min((int32_t)m_MapWidth - 1 - m_StartPos.x, (int32_t)m_MapHeight - 1 - m_StartPos.y));
+		const uint32_t checkSteps = 2 * std::min(m_MapWidth, m_MapHeight) + startClearance;
+		assert(walker.CountInfinite(checkSteps) == walker.StepFrontier(checkSteps, 2));
+		(void)checkSteps;
 
-		int64_t maxTouchesAtLimit = p0 + p1 * iters + (iters * (iters - 1LL) / 2LL) * (p2 - p1);
+		uint64_t maxTouchesAtLimit = walker.CountInfinite(STEP_LIMIT);
 
-		Log("Total Reachable Steps: %lld", maxTouchesAtLimit);
+		Log("Total Reachable Steps: %" PRIu64, maxTouchesAtLimit);
 
 		// Done.
 		AdventGUIInstance::PartTwo(context);
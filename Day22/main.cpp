@@ -3,35 +3,14 @@
 
 #include "AdventGUI/AdventGUI.h"
 
-#include "ACUtils/Algorithm.h"
-#include "ACUtils/Hash.h"
-#include "ACUtils/AABB.h"
+#include "ACUtils/IntVec.h"
 #include "ACUtils/StringUtil.h"
+#include <algorithm>
 #include <vector>
-#include <queue>
-#include <unordered_set>
 
 struct Brick
 {
-	Brick(const std::string& _name, const IntVec3& _min, const IntVec3& _max): Name(_name), Min(_min), Max(_max){}
-
-	bool Intersects(const Brick& RHS) const
-	{
-		return Min.AllLessThanOrEqual(RHS.Max) && Max.AllGreaterThanOrEqual(RHS.Min);
-	}
-
-	bool Touches(const Brick& RHS) const
-	{
-		IntAABB2D LHSBox(Min.XY(), Max.XY());
-		IntAABB2D RHSBox(RHS.Min.XY(), RHS.Max.XY());
-
-		if (LHSBox.Intersects(RHSBox) || LHSBox.Contains(RHSBox.GetMin()))
-		{
-			return abs(Max.z - RHS.Min.z) == 1;
-		}
-
-		return false;
-	}
+	Brick(const IntVec3& _min, const IntVec3& _max): Min(_min), Max(_max){}
 
 	void Drop(int32_t dist)
 	{
@@ -39,56 +18,161 @@ struct Brick
 		Max.z -= dist;
 	}
 
-	bool operator==(const Brick& RHS) const
-	{
-		return _stricmp(Name.c_str(), RHS.Name.c_str()) == 0 && Min == RHS.Min && Max == RHS.Max;
-	}
-
-	std::string Name;
 	IntVec3 Min;
 	IntVec3 Max;
 	std::vector<int32_t> Supports;
 	std::vector<int32_t> SupportedBy;
 };
 
-void ToBase26(size_t value, std::string& outString)
+// Drops bricks onto a height map over their combined XY footprint. Each cell tracks the current top z and which brick owns it,
+// so a brick's rest height and the bricks it lands on both fall out of a single pass over its own footprint.
+class BrickSettler
 {
-	if (value >= 26)
+public:
+	// Bricks must be sorted by Min.z. Fills in Supports / SupportedBy as indices into bricks.
+	void Settle(std::vector<Brick>& bricks)
 	{
-		ToBase26(value / 26 - 1, outString);
+		if (bricks.empty())
+		{
+			return;
+		}
+
+		IntVec2 footprintMin = bricks[0].Min.XY();
+		IntVec2 footprintMax = bricks[0].Max.XY();
+		for (const Brick& brick : bricks)
+		{
+			footprintMin = footprintMin.PerComponentMin(brick.Min.XY());
+			footprintMax = footprintMax.PerComponentMax(brick.Max.XY());
+		}
+
+		m_origin = footprintMin;
+		m_width = footprintMax.x - footprintMin.x + 1;
+		const int32_t height = footprintMax.y - footprintMin.y + 1;
+		m_topZ.assign((size_t)m_width * height, 0);
+		m_topBrick.assign((size_t)m_width * height, NO_BRICK);
+		m_lastSupportStamp.assign(bricks.size(), NO_BRICK);
+
+		for (int32_t brickIndex = 0; brickIndex < (int32_t)bricks.size(); ++brickIndex)
+		{
+			Brick& brick = bricks[brickIndex];
+			assert(brickIndex == 0 || bricks[brickIndex - 1].Min.z <= brick.Min.z);
+
+			// Highest thing under us, we'll rest right on top of it.
+			int32_t restZ = 0;
+			ForEachCell(brick, [&](size_t cell) { restZ = std::max(restZ, m_topZ[cell]); });
+			brick.Drop(brick.Min.z - (restZ + 1));
+
+			// Anything whose top is exactly at restZ under our footprint is holding us up.
+			ForEachCell(brick, [&](size_t cell)
+			{
+				const int32_t supporter = m_topBrick[cell];
+				if (supporter != NO_BRICK && m_topZ[cell] == restZ && m_lastSupportStamp[supporter] != brickIndex)
+				{
+					m_lastSupportStamp[supporter] = brickIndex;
+					bricks[supporter].Supports.push_back(brickIndex);
+					brick.SupportedBy.push_back(supporter);
+				}
+
+				m_topZ[cell] = brick.Max.z;
+				m_topBrick[cell] = brickIndex;
+			});
+		}
 	}
 
-	outString += ('A' + (char)(value % 26));
-}
+private:
+	static constexpr int32_t NO_BRICK = -1;
 
-class AdventDay : public AdventGUIInstance
+	template<typename Func>
+	void ForEachCell(const Brick& brick, Func func) const
+	{
+		for (int32_t y = brick.Min.y; y <= brick.Max.y; ++y)
+		{
+			size_t cell = (size_t)(y - m_origin.y) * m_width + (brick.Min.x - m_origin.x);
+			for (int32_t x = brick.Min.x; x <= brick.Max.x; ++x, ++cell)
+			{
+				func(cell);
+			}
+		}
+	}
+
+	IntVec2 m_origin;
+	int32_t m_width = 0;
+	std::vector<int32_t> m_topZ;
+	std::vector<int32_t> m_topBrick;
+	std::vector<int32_t> m_lastSupportStamp; // Last brick that recorded this one as a supporter, dedupes multi-cell contact.
+};
+
+constexpr int32_t BrickSettler::NO_BRICK;
+
+// Dominator tree over the support DAG, with the ground as the root. Settled bricks are already in topological order
+// (everyone's supporters come before them), so Cooper-Harvey-Kennedy converges in a single forward pass.
+class BrickDominatorTree
 {
 public:
-	AdventDay(const AdventGUIParams& params)
-		: AdventGUIInstance(params)
-	{};
-private:
-	struct FindCollidingBricks
+	void Build(const std::vector<Brick>& bricks)
 	{
-		FindCollidingBricks(const Brick& _brick) : brick(_brick)
+		const int32_t brickCount = (int32_t)bricks.size();
+		m_ground = brickCount;
+		m_idom.assign(brickCount + 1, m_ground);
+		m_depth.assign(brickCount + 1, 0);
+		m_subtreeSize.assign(brickCount + 1, 1);
+
+		for (int32_t brickIndex = 0; brickIndex < brickCount; ++brickIndex)
 		{
-			brick.Min = brick.Min - IntVec3(0, 0, 1);
-			brick.Max = brick.Max + IntVec3(0, 0, 1);
+			const Brick& brick = bricks[brickIndex];
+
+			int32_t idom = brick.SupportedBy.empty() ? m_ground : brick.SupportedBy[0];
+			for (size_t i = 1; i < brick.SupportedBy.size(); ++i)
+			{
+				idom = Intersect(idom, brick.SupportedBy[i]);
+			}
+
+			assert(idom == m_ground || idom < brickIndex);
+			m_idom[brickIndex] = idom;
+			m_depth[brickIndex] = m_depth[idom] + 1;
 		}
 
-		bool operator()(const Brick& RHS) const
+		// Children always have a higher index than their idom, so a reverse sweep rolls sizes up the tree.
+		for (int32_t brickIndex = brickCount - 1; brickIndex >= 0; --brickIndex)
 		{
-			if (_stricmp(brick.Name.c_str(), RHS.Name.c_str()) == 0)
+			m_subtreeSize[m_idom[brickIndex]] += m_subtreeSize[brickIndex];
+		}
+	}
+
+	// Number of bricks (including brickIndex) that come down if brickIndex is removed.
+	size_t GetSubtreeSize(int32_t brickIndex) const { return m_subtreeSize[brickIndex]; }
+
+private:
+	// Nearest common dominator, walking the deeper side up until they meet.
+	int32_t Intersect(int32_t a, int32_t b) const
+	{
+		while (a != b)
+		{
+			if (m_depth[a] < m_depth[b])
 			{
-				return false;
+				b = m_idom[b];
+			}
+			else
+			{
+				a = m_idom[a];
 			}
-
-			return brick.Intersects(RHS);
 		}
+		return a;
+	}
 
-		Brick brick;
-	};
+	int32_t m_ground = 0;
+	std::vector<int32_t> m_idom;
+	std::vector<int32_t> m_depth;
+	std::vector<size_t> m_subtreeSize;
+};
 
+class AdventDay : public AdventGUIInstance
+{
+public:
+	AdventDay(const AdventGUIParams& params)
+		: AdventGUIInstance(params)
+	{};
+private:
 	virtual void ParseInput(FileStreamReader& fileReader) override
 	{
 		// Parse Input. Input never changes between parts of a problem.
@@ -97,9 +181,7 @@ private:
 
 		IntVec3 left;
 		IntVec3 right;
-		std::string name;
 
-		int32_t maxZ = 0;
 		while (!fileReader.IsEOF())
 		{
 			line = fileReader.ReadLine();
@@ -118,74 +200,15 @@ private:
 
 			assert(left.AllLessThanOrEqual(right));
 
-			maxZ = std::max(maxZ, right.z);
-
-			name.clear();
-			size_t totalExisting = m_Bricks.size();
-
-			ToBase26(m_Bricks.size(), name);
-
-			m_Bricks.emplace_back(name, left, right);
+			m_Bricks.emplace_back(left, right);
 		}
 
 		// Sort by Z
 		std::sort(m_Bricks.begin(), m_Bricks.end(), [](const Brick& LHS, const Brick& RHS) { return LHS.Min.z < RHS.Min.z; });
 
-		// Fall blocks to stable positions.
-		bool foundCollision = false;
-		m_Bricks[0].Drop(m_Bricks[0].Min.z - 1); // Move to the ground.
-		for (size_t i = 1; i < m_Bricks.size(); ++i)
-		{
-			const Brick& fallingBrick = m_Bricks[i];
-
-			foundCollision = false;
-			int32_t closestDistance = INT_MAX;
-			for (size_t j = i; j > 0; --j)
-			{
-				// Move the block to our top.
-				const Brick& brickAtRest = m_Bricks[j - 1];
-
-				int32_t dist = fallingBrick.Min.z - brickAtRest.Max.z;
-				Brick colTest = fallingBrick;
-				colTest.Drop(dist);
-
-				if (brickAtRest.Intersects(colTest))
-				{
-					foundCollision = true;
-					closestDistance = std::min(closestDistance, dist - 1);
-				}
-			}
-
-			if (!foundCollision)
-			{
-				m_Bricks[i].Drop(m_Bricks[i].Min.z - 1); // Move to the ground.
-			}
-			else
-			{
-				m_Bricks[i] = fallingBrick;
-				m_Bricks[i].Drop(closestDistance);
-			}
-		}
-
-		// Do one more pass to establish supports/supported by dependencies.
-		for (size_t i = 0; i < m_Bricks.size(); ++i)
-		{
-			Brick& currentBrick = m_Bricks[i];
-
-			std::vector<int> allColliders = Algorithm::find_all_indices(m_Bricks.begin(), m_Bricks.end(), FindCollidingBricks(currentBrick));
-			for (int32_t colliderIdx : allColliders)
-			{
-				if (m_Bricks[colliderIdx].Min.z >= currentBrick.Max.z)
-				{
-					currentBrick.Supports.push_back(colliderIdx);
-				}
-				else
-				{
-					currentBrick.SupportedBy.push_back(colliderIdx);
-				}
-			}
-		}
-
+		// Fall blocks to stable positions, establishing supports / supported by as we go.
+		BrickSettler settler;
+		settler.Settle(m_Bricks);
 	}
 
 	virtual void PartOne(const AdventGUIContext& context) override
@@ -219,37 +242,15 @@ private:
 	virtual void PartTwo(const AdventGUIContext& context) override
 	{	
 		// Part Two
-		std::queue<const Brick*> fallQueue;
+		// A brick falls when removing X iff every path from the ground up to it runs through X, i.e. X dominates it.
+		// So the chain reaction for X is just the size of X's dominator subtree (minus X itself).
+		BrickDominatorTree dominators;
+		dominators.Build(m_Bricks);
+
 		size_t totalThatWouldFall = 0;
-		for (const Brick& brick : m_Bricks)
+		for (int32_t brickIndex = 0; brickIndex < (int32_t)m_Bricks.size(); ++brickIndex)
 		{
-			fallQueue.push(&brick);
-			std::unordered_set<const Brick*> fallingSet;
-			while (!fallQueue.empty())
-			{
-				const Brick* fallingBrick = fallQueue.front();
-				fallQueue.pop();
-
-				fallingSet.insert(fallingBrick);
-
-				// Check all our supports, if they have any supports that AREN'T falling yet, check again later. 
-				for (int32_t supportIdx : fallingBrick->Supports)
-				{
-					bool canFall = true;
-					
-					for (int32_t supportedByIdx : m_Bricks[supportIdx].SupportedBy)
-					{
-						canFall &= (fallingSet.find(&m_Bricks[supportedByIdx]) != fallingSet.end());
-					}
-					
-					if (canFall)
-					{
-						fallQueue.push(&m_Bricks[supportIdx]);
-						++totalThatWouldFall;
-					}
-				}
-			}
-
+			totalThatWouldFall += dominators.GetSubtreeSize(brickIndex) - 1;
 		}
 
 		Log("Total: %zd", totalThatWouldFall);
@@ -6,139 +6,613 @@
 #include "ACUtils/Algorithm.h"
 #include "ACUtils/Hash.h"
 #include "ACUtils/BDFS.h"
+#include "ACUtils/Bit.h"
 #include "ACUtils/IntVec.h"
+#include "ACUtils/Parallel.h"
 #include "ACUtils/StringUtil.h"
+#include <atomic>
 #include <vector>
 #include <queue>
+#include <unordered_map>
 #include <unordered_set>
 
-class AdventDay : public AdventGUIInstance
+// Longest simple path over a small (<= 64 node) undirected graph. Adjacency lives in CSR arrays plus a neighbor mask per node,
+// so a partial walk is nothing more than (node, visited mask, length).
+// Graphs that sweep with a narrow frontier (grids, like the condensed maze) are solved with a profile DP, anything else falls
+// back to a parallel branch and bound DFS.
+class LongestPathSolver
 {
 public:
-	AdventDay(const AdventGUIParams& params)
-		: AdventGUIInstance(params), m_MapWidth(0), m_MapHeight(0)
-	{};
-private:
-	struct Vert
+	static constexpr uint32_t MAX_NODES = 64;
+	static constexpr int32_t NO_PATH = -1;
+
+	LongestPathSolver(uint32_t nodeCount) : m_nodeCount(nodeCount)
 	{
-		Vert(const IntVec2& _pos):pos(_pos), connections{ nullptr }, numConnections(0) {};
-		Vert():pos(0), connections{nullptr}, numConnections(0) {};
+		assert(nodeCount > 0 && nodeCount <= MAX_NODES);
+	}
 
-		void Connect(const Vert* to)
+	// The solver treats the graph as undirected (the sweep walks each edge from either end, goal forcing reads the neighbor
+	// masks both ways), so every edge has to be added in both directions with the same length. Build asserts on this.
+	void AddEdge(uint32_t from, uint32_t to, int32_t length)
+	{
+		assert(from < m_nodeCount && to < m_nodeCount && length >= 0);
+		m_pendingEdges.push_back({ from, to, length });
+	}
+
+	// Compacts pending edges into CSR form. Must be called before Solve.
+	void Build()
+	{
+		std::sort(m_pendingEdges.begin(), m_pendingEdges.end(), [](const PendingEdge& LHS, const PendingEdge& RHS) { return LHS.from < RHS.from; });
+
+		m_edgeOffsets.assign(m_nodeCount + 1, 0);
+		m_edgeTargets.clear();
+		m_edgeLengths.clear();
+		m_neighborMask.assign(m_nodeCount, 0);
+		m_maxIncoming.assign(m_nodeCount, 0);
+
+		for (const PendingEdge& edge : m_pendingEdges)
 		{
-			assert(numConnections < 4);
-			connections[numConnections++] = to;
+			++m_edgeOffsets[edge.from + 1];
+			m_edgeTargets.push_back(edge.to);
+			m_edgeLengths.push_back(edge.length);
+			m_neighborMask[edge.from] |= 1ULL << edge.to;
+			m_maxIncoming[edge.to] = std::max(m_maxIncoming[edge.to], edge.length);
 		}
 
-		const Vert* connections[4];
-		uint8_t numConnections;
-		IntVec2 pos;
-	};
+		for (uint32_t i = 0; i < m_nodeCount; ++i)
+		{
+			m_edgeOffsets[i + 1] += m_edgeOffsets[i];
+		}
 
-	typedef std::vector<std::vector<std::pair<int32_t, int32_t>>> VertAdjLengthVector;
-	typedef std::vector<const Vert*> VertVector;
+		// Every edge needs its reverse, with the same length.
+		for (uint32_t from = 0; from < m_nodeCount; ++from)
+		{
+			for (uint32_t edge = m_edgeOffsets[from]; edge < m_edgeOffsets[from + 1]; ++edge)
+			{
+				const uint32_t to = m_edgeTargets[edge];
+				const uint32_t* reverseBegin = m_edgeTargets.data() + m_edgeOffsets[to];
+				const uint32_t* reverseEnd = m_edgeTargets.data() + m_edgeOffsets[to + 1];
+				const uint32_t* reverse = std::find(reverseBegin, reverseEnd, from);
+				assert(reverse != reverseEnd && m_edgeLengths[reverse - m_edgeTargets.data()] == m_edgeLengths[edge]);
+			}
+		}
+
+		m_pendingEdges.clear();
+	}
 
-	struct GraphWalkState
+	// Length of the longest simple path from start to goal, or NO_PATH.
+	int32_t Solve(uint32_t start, uint32_t goal) const
 	{
-		GraphWalkState(uint64_t oldVisited, const Vert* next, uint32_t inSteps): current(next), visited ( oldVisited ), totalSteps(inSteps), hash(0)
+		assert(start < m_nodeCount && goal < m_nodeCount && start != goal);
+		assert(m_edgeOffsets.size() == m_nodeCount + 1);
+
+		SearchParams params;
+		params.goal = goal;
+		params.blocked = 0;
+		params.goalBonus = 0;
+
+		// If the goal only has one way in, the junction before it is forced to be our last stop. Retarget there and carry the
+		// final leg as a bonus, the goal itself is now off limits. Chains of these collapse the same way.
+		while (params.goal != start && Bits::PopCount64(m_neighborMask[params.goal] & ~params.blocked) == 1)
+		{
+			const uint32_t lastJunction = (uint32_t)Bits::GetLeastSignificantBitIndex(m_neighborMask[params.goal] & ~params.blocked);
+			params.goalBonus += GetEdgeLength(lastJunction, params.goal);
+			params.blocked |= 1ULL << params.goal;
+			params.goal = lastJunction;
+		}
+
+		// Grid-like graphs (which is what the maze condenses to) sweep with a narrow frontier, so the profile DP handles them outright.
+		std::vector<uint32_t> vertexOrder;
+		if (GetSweepOrder(start, params, vertexOrder) <= MAX_PROFILE_SLOTS)
 		{
-			hash = visited | (uint64_t)totalSteps << 37UL;
+			const int32_t result = SolveProfile(start, params, vertexOrder);
+			return result == NO_PATH ? NO_PATH : result + params.goalBonus;
 		}
 
-		const Vert* current;
+		// Otherwise branch and bound. Fan the first few levels out into independent prefixes and hand those to the workers.
+		std::vector<PathPrefix> prefixes;
+		CollectPrefixes(params, start, (1ULL << start) | params.blocked, 0, FAN_OUT_DEPTH, prefixes);
+
+		std::atomic<int32_t> best(NO_PATH);
+		std::vector<SearchContext> contexts(Parallel::GetWorkerCount(prefixes.size()), SearchContext(params, m_nodeCount, best));
+		Parallel::ForEach(prefixes.size(), [&](uint32_t workerIndex, size_t prefixIndex)
+		{
+			const PathPrefix& prefix = prefixes[prefixIndex];
+			Search(contexts[workerIndex], prefix.node, prefix.visited, prefix.length);
+		});
+
+		const int32_t result = best.load();
+		return result == NO_PATH ? NO_PATH : result + params.goalBonus;
+	}
+
+private:
+	// Reachable components this small get solved exactly and memoized on (node, component) instead of branch and bound.
+	static constexpr uint32_t MEMO_COMPONENT_LIMIT = 24;
+	static constexpr uint32_t FAN_OUT_DEPTH = 6;
+
+	// Profile states pack one 4 bit code per frontier slot into a uint64_t.
+	static constexpr uint32_t MAX_PROFILE_SLOTS = 16;
+	static constexpr uint8_t SLOT_UNUSED = 0; // No path edges touch this vertex yet.
+	static constexpr uint8_t SLOT_INTERIOR = 1; // Both path edges used, the path runs through here.
+	static constexpr uint8_t SLOT_FIRST_LABEL = 2; // Path fragment end, the two ends of a fragment share a label.
+
+	struct PendingEdge
+	{
+		uint32_t from;
+		uint32_t to;
+		int32_t length;
+	};
+
+	struct SearchParams
+	{
+		uint32_t goal;
+		uint64_t blocked;
+		int32_t goalBonus;
+	};
+
+	struct PathPrefix
+	{
+		uint32_t node;
 		uint64_t visited;
-		uint32_t totalSteps;
-		size_t hash;
+		int32_t length;
 	};
 
-	class GraphWalkBDFSNode : public BDFS::BDFSNode<GraphWalkState>
+	// Per worker. The memo holds exact best remaining lengths keyed by the still-open component, one table per node.
+	struct SearchContext
 	{
-	public:
-		GraphWalkBDFSNode(const GraphWalkState& state) : BDFSNode(state) { }
+		SearchContext(const SearchParams& _params, uint32_t nodeCount, std::atomic<int32_t>& _best) : params(_params), memo(nodeCount), best(&_best) {}
 
-		virtual size_t GetHash() const override
+		void SubmitLength(int32_t length)
 		{
-			const GraphWalkState& state = GetState();
-			return state.hash;
+			int32_t current = best->load(std::memory_order_relaxed);
+			while (length > current && !best->compare_exchange_weak(current, length, std::memory_order_relaxed))
+			{
+			}
 		}
+
+		SearchParams params;
+		std::vector<std::unordered_map<uint64_t, int32_t>> memo;
+		std::atomic<int32_t>* best;
 	};
 
-	class GraphWalkExecuter : public BDFS::BDFSExecuter<GraphWalkState>
+	int32_t GetEdgeLength(uint32_t from, uint32_t to) const
 	{
-	public:
-		GraphWalkExecuter(const VertVector* nodes, const VertAdjLengthVector* adjInfo, IntVec2 goalPos)
-			: BDFSExecuter(BDFSExecuterMode::BDFSExecuterMode_BreadthFirst), m_Goal(goalPos), m_Nodes(nodes), m_AdjInfo(adjInfo)
+		int32_t length = NO_PATH;
+		for (uint32_t edge = m_edgeOffsets[from]; edge < m_edgeOffsets[from + 1]; ++edge)
+		{
+			if (m_edgeTargets[edge] == to)
+			{
+				length = std::max(length, m_edgeLengths[edge]);
+			}
+		}
+		return length;
+	}
+
+	// Everything in available we can still get to from node, not counting node itself.
+	uint64_t GetReachable(uint32_t node, uint64_t available) const
+	{
+		uint64_t frontier = m_neighborMask[node] & available;
+		uint64_t reached = frontier;
+		while (frontier)
+		{
+			uint64_t next = 0;
+			for (uint64_t bits = frontier; bits; bits &= bits - 1)
+			{
+				next |= m_neighborMask[Bits::GetLeastSignificantBitIndex(bits)];
+			}
+			frontier = next & available & ~reached;
+			reached |= frontier;
+		}
+		return reached;
+	}
+
+	// Every node still to be walked has to be entered through some edge, so the longest way into each is a safe cap on what's left.
+	int32_t GetUpperBound(uint64_t component) const
+	{
+		int32_t bound = 0;
+		for (uint64_t bits = component; bits; bits &= bits - 1)
+		{
+			bound += m_maxIncoming[Bits::GetLeastSignificantBitIndex(bits)];
+		}
+		return bound;
+	}
+
+	void CollectPrefixes(const SearchParams& params, uint32_t node, uint64_t visited, int32_t length, uint32_t depth, std::vector<PathPrefix>& outPrefixes) const
+	{
+		if (depth == 0 || node == params.goal)
+		{
+			outPrefixes.push_back({ node, visited, length });
+			return;
+		}
+
+		for (uint32_t edge = m_edgeOffsets[node]; edge < m_edgeOffsets[node + 1]; ++edge)
+		{
+			const uint32_t target = m_edgeTargets[edge];
+			if ((visited & (1ULL << target)) == 0)
+			{
+				CollectPrefixes(params, target, visited | (1ULL << target), length + m_edgeLengths[edge], depth - 1, outPrefixes);
+			}
+		}
+	}
+
+	void Search(SearchContext& context, uint32_t node, uint64_t visited, int32_t length) const
+	{
+		const uint32_t goal = context.params.goal;
+		if (node == goal)
+		{
+			context.SubmitLength(length);
+			return;
+		}
+
+		const uint64_t component = GetReachable(node, GetAllNodesMask() & ~visited);
+		if ((component & (1ULL << goal)) == 0)
+		{
+			// Walled ourselves off.
+			return;
+		}
+
+		if (Bits::PopCount64(component) <= MEMO_COMPONENT_LIMIT)
+		{
+			const int32_t remaining = SolveExact(context, node, component);
+			if (remaining != NO_PATH)
+			{
+				context.SubmitLength(length + remaining);
+			}
+			return;
+		}
+
+		if (length + GetUpperBound(component) <= context.best->load(std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		for (uint32_t edge = m_edgeOffsets[node]; edge < m_edgeOffsets[node + 1]; ++edge)
+		{
+			const uint32_t target = m_edgeTargets[edge];
+			if (component & (1ULL << target))
+			{
+				Search(context, target, visited | (1ULL << target), length + m_edgeLengths[edge]);
+			}
+		}
+	}
+
+	// Longest remaining walk from node to the goal using only nodes in component (which is exactly what's reachable from node).
+	// Only depends on (node, component), so it memoizes cleanly.
+	int32_t SolveExact(SearchContext& context, uint32_t node, uint64_t component) const
+	{
+		const uint32_t goal = context.params.goal;
+		if (node == goal)
+		{
+			return 0;
+		}
+
+		std::unordered_map<uint64_t, int32_t>& nodeMemo = context.memo[node];
+		std::unordered_map<uint64_t, int32_t>::const_iterator itFind = nodeMemo.find(component);
+		if (itFind != nodeMemo.end())
 		{
-			GraphWalkState rootState(1, (*nodes)[0], 0);
-			QueueNode(new GraphWalkBDFSNode(rootState));
+			return itFind->second;
 		}
 
-		virtual bool ProcessNode(const BDFS::BDFSNode<GraphWalkState>* node) override
+		int32_t best = NO_PATH;
+		for (uint32_t edge = m_edgeOffsets[node]; edge < m_edgeOffsets[node + 1]; ++edge)
 		{
-			const GraphWalkState& currentState = node->GetState();
+			const uint32_t target = m_edgeTargets[edge];
+			if ((component & (1ULL << target)) == 0)
+			{
+				continue;
+			}
+
+			const uint64_t targetComponent = target == goal ? 0 : GetReachable(target, component & ~(1ULL << target));
+			if (target != goal && (targetComponent & (1ULL << goal)) == 0)
+			{
+				continue;
+			}
 
-			if (currentState.current->pos == m_Goal)
+			const int32_t remaining = SolveExact(context, target, targetComponent);
+			if (remaining != NO_PATH)
 			{
-				if (std::find_if(m_SolvedStates.begin(), m_SolvedStates.end(), [&](const GraphWalkState& LHS) { return LHS.totalSteps == currentState.totalSteps; }) == m_SolvedStates.end())
+				best = std::max(best, m_edgeLengths[edge] + remaining);
+			}
+		}
+
+		nodeMemo[component] = best;
+		return best;
+	}
+
+	struct SweepEdge
+	{
+		uint32_t from;
+		uint32_t to;
+		int32_t length;
+		uint32_t finishes[2]; // Vertices (other than terminals) that have no edges left after this one. ~0U if none.
+	};
+
+	bool IsTerminal(uint32_t node, uint32_t start, const SearchParams& params) const { return node == start || node == params.goal; }
+
+	// BFS order from the start, skipping blocked nodes. Returns the widest the frontier gets when edges are swept in that order.
+	uint32_t GetSweepOrder(uint32_t start, const SearchParams& params, std::vector<uint32_t>& outOrder) const
+	{
+		outOrder.clear();
+		uint64_t seen = (1ULL << start) | params.blocked;
+		outOrder.push_back(start);
+		for (size_t head = 0; head < outOrder.size(); ++head)
+		{
+			for (uint64_t bits = m_neighborMask[outOrder[head]] & ~seen; bits; bits &= bits - 1)
+			{
+				const uint32_t next = (uint32_t)Bits::GetLeastSignificantBitIndex(bits);
+				seen |= 1ULL << next;
+				outOrder.push_back(next);
+			}
+		}
+
+		std::vector<SweepEdge> sweep;
+		BuildSweep(start, params, outOrder, sweep);
+
+		// Terminals stay on the frontier the whole way.
+		uint32_t width = 2;
+		uint32_t widest = width;
+		uint64_t onFrontier = (1ULL << start) | (1ULL << params.goal);
+		for (const SweepEdge& edge : sweep)
+		{
+			for (uint32_t node : { edge.from, edge.to })
+			{
+				if ((onFrontier & (1ULL << node)) == 0)
 				{
-					m_SolvedStates.push_back(currentState);
+					onFrontier |= 1ULL << node;
+					widest = std::max(widest, ++width);
 				}
 			}
-			else
+
+			for (uint32_t finished : edge.finishes)
 			{
-				// Keep going.
+				width -= finished != ~0U ? 1 : 0;
+			}
+		}
+		return widest;
+	}
 
-				int32_t nodeIdx = GetIndexForNode(currentState.current);
-				assert(nodeIdx != -1);
+	// Edges between reachable nodes, sorted so each vertex's edges cluster around its place in the order.
+	void BuildSweep(uint32_t start, const SearchParams& params, const std::vector<uint32_t>& vertexOrder, std::vector<SweepEdge>& outSweep) const
+	{
+		std::vector<uint32_t> rank(m_nodeCount, ~0U);
+		for (uint32_t i = 0; i < (uint32_t)vertexOrder.size(); ++i)
+		{
+			rank[vertexOrder[i]] = i;
+		}
 
-				for ( const std::pair<int32_t, int32_t>& kvp : (*m_AdjInfo)[nodeIdx])
+		outSweep.clear();
+		for (uint32_t from : vertexOrder)
+		{
+			for (uint32_t edge = m_edgeOffsets[from]; edge < m_edgeOffsets[from + 1]; ++edge)
+			{
+				const uint32_t to = m_edgeTargets[edge];
+				if (rank[to] != ~0U && rank[from] < rank[to])
 				{
-					if ((currentState.visited & (1ULL << kvp.first)) == 0)
-					{
-						GraphWalkState newWalkState(currentState.visited | (1ULL << kvp.first), (*m_Nodes)[kvp.first], currentState.totalSteps + kvp.second);
-						
-						//std::unordered_map<uint64_t, uint32_t>::const_iterator itFind = m_Cache.find(newWalkState.visited);
-						//if (itFind != m_Cache.end())
-						//{
-						//	if (itFind->second > newWalkState.totalSteps)
-						//	{
-						//		// Last one was better by this point.
-						//		continue;
-						//	}
-						//}
-
-						//m_Cache[newWalkState.visited] = newWalkState.totalSteps;
-						
-						QueueNode(new GraphWalkBDFSNode(newWalkState));
-					}
+					outSweep.push_back({ from, to, m_edgeLengths[edge], { ~0U, ~0U } });
 				}
 			}
+		}
 
-			delete node;
+		std::sort(outSweep.begin(), outSweep.end(), [&](const SweepEdge& LHS, const SweepEdge& RHS)
+		{
+			const uint32_t leftMax = std::max(rank[LHS.from], rank[LHS.to]);
+			const uint32_t rightMax = std::max(rank[RHS.from], rank[RHS.to]);
+			return leftMax != rightMax ? leftMax < rightMax : std::min(rank[LHS.from], rank[LHS.to]) < std::min(rank[RHS.from], rank[RHS.to]);
+		});
 
-			return false;
-		};
+		std::vector<uint32_t> lastEdge(m_nodeCount, ~0U);
+		for (uint32_t i = 0; i < (uint32_t)outSweep.size(); ++i)
+		{
+			lastEdge[outSweep[i].from] = i;
+			lastEdge[outSweep[i].to] = i;
+		}
+
+		for (uint32_t i = 0; i < (uint32_t)outSweep.size(); ++i)
+		{
+			SweepEdge& edge = outSweep[i];
+			uint32_t finishCount = 0;
+			for (uint32_t node : { edge.from, edge.to })
+			{
+				if (lastEdge[node] == i && !IsTerminal(node, start, params))
+				{
+					edge.finishes[finishCount++] = node;
+				}
+			}
+		}
+	}
+
+	// Frontier (profile) DP over edges in sweep order. A state is what each frontier vertex looks like so far (unused, interior,
+	// or the end of a fragment and which fragment), and only the best length per state is kept. Terminals take exactly one edge,
+	// everybody else zero or two, and fragments may never close into a loop.
+	int32_t SolveProfile(uint32_t start, const SearchParams& params, const std::vector<uint32_t>& vertexOrder) const
+	{
+		std::vector<SweepEdge> sweep;
+		BuildSweep(start, params, vertexOrder, sweep);
+
+		std::vector<uint32_t> frontier = { start, params.goal };
+		std::unordered_map<uint64_t, int32_t> states;
+		std::unordered_map<uint64_t, int32_t> nextStates;
+		states[0] = 0;
 
-		int32_t GetIndexForNode(const Vert* node) const
+		uint8_t codes[MAX_PROFILE_SLOTS];
+		for (const SweepEdge& edge : sweep)
 		{
-			for (size_t i = 0; i < m_Nodes->size(); ++i)
+			for (uint32_t node : { edge.from, edge.to })
+			{
+				if (std::find(frontier.begin(), frontier.end(), node) == frontier.end())
+				{
+					frontier.push_back(node); // New slot is SLOT_UNUSED, which every packed state already reads as.
+				}
+			}
+
+			const uint32_t fromSlot = (uint32_t)(std::find(frontier.begin(), frontier.end(), edge.from) - frontier.begin());
+			const uint32_t toSlot = (uint32_t)(std::find(frontier.begin(), frontier.end(), edge.to) - frontier.begin());
+			const bool fromTerminal = IsTerminal(edge.from, start, params);
+			const bool toTerminal = IsTerminal(edge.to, start, params);
+
+			uint32_t finishedSlots[2];
+			uint32_t finishedCount = 0;
+			for (uint32_t finished : edge.finishes)
+			{
+				if (finished != ~0U)
+				{
+					finishedSlots[finishedCount++] = (uint32_t)(std::find(frontier.begin(), frontier.end(), finished) - frontier.begin());
+				}
+			}
+			std::sort(finishedSlots, finishedSlots + finishedCount);
+
+			nextStates.clear();
+			for (const std::pair<const uint64_t, int32_t>& kvp : states)
 			{
-				if ((*m_Nodes)[i] == node)
+				UnpackProfile(kvp.first, (uint32_t)frontier.size(), codes);
+
+				// Leave the edge out.
+				StoreProfile(codes, (uint32_t)frontier.size(), finishedSlots, finishedCount, kvp.second, nextStates);
+
+				// Take it, if both ends can take another edge and it doesn't close a loop.
+				uint8_t& fromCode = codes[fromSlot];
+				uint8_t& toCode = codes[toSlot];
+				if (fromCode == SLOT_INTERIOR || toCode == SLOT_INTERIOR || (fromTerminal && fromCode != SLOT_UNUSED) || (toTerminal && toCode != SLOT_UNUSED) || (fromCode >= SLOT_FIRST_LABEL && fromCode == toCode))
+				{
+					continue;
+				}
+
+				if (fromCode == SLOT_UNUSED && toCode == SLOT_UNUSED)
+				{
+					fromCode = toCode = (uint8_t)(MAX_PROFILE_SLOTS - 1); // Fresh fragment, StoreProfile relabels it.
+				}
+				else if (fromCode == SLOT_UNUSED)
+				{
+					fromCode = toCode;
+					toCode = SLOT_INTERIOR;
+				}
+				else if (toCode == SLOT_UNUSED)
+				{
+					toCode = fromCode;
+					fromCode = SLOT_INTERIOR;
+				}
+				else
 				{
-					return (int32_t)i;
+					// Joining two fragments, their far ends are now the ends of one.
+					const uint8_t mergedLabel = toCode;
+					const uint8_t keptLabel = fromCode;
+					fromCode = toCode = SLOT_INTERIOR;
+					std::replace(codes, codes + frontier.size(), mergedLabel, keptLabel);
 				}
+
+				StoreProfile(codes, (uint32_t)frontier.size(), finishedSlots, finishedCount, kvp.second + edge.length, nextStates);
 			}
 
-			return -1;
+			for (uint32_t i = finishedCount; i > 0; --i)
+			{
+				frontier.erase(frontier.begin() + finishedSlots[i - 1]);
+			}
+			std::swap(states, nextStates);
+		}
+
+		// All that's left on the frontier is the two terminals, and they have to be the ends of the same fragment.
+		assert(frontier.size() == 2);
+		const uint64_t finished = (uint64_t)SLOT_FIRST_LABEL | ((uint64_t)SLOT_FIRST_LABEL << 4);
+		std::unordered_map<uint64_t, int32_t>::const_iterator itFind = states.find(finished);
+		return itFind != states.end() ? itFind->second : NO_PATH;
+	}
+
+	static void UnpackProfile(uint64_t packed, uint32_t slotCount, uint8_t* outCodes)
+	{
+		for (uint32_t i = 0; i < slotCount; ++i, packed >>= 4)
+		{
+			outCodes[i] = (uint8_t)(packed & 0xF);
+		}
+	}
+
+	// Drops finished slots (rejecting the state if one is left as a dangling fragment end), relabels fragments in order of
+	// appearance so equivalent states pack the same, and keeps the longest length per state.
+	static void StoreProfile(const uint8_t* codes, uint32_t slotCount, const uint32_t* finishedSlots, uint32_t finishedCount, int32_t length, std::unordered_map<uint64_t, int32_t>& outStates)
+	{
+		for (uint32_t i = 0; i < finishedCount; ++i)
+		{
+			if (codes[finishedSlots[i]] >= SLOT_FIRST_LABEL)
+			{
+				return;
+			}
+		}
+
+		uint8_t relabel[MAX_PROFILE_SLOTS] = { 0 };
+		uint8_t nextLabel = SLOT_FIRST_LABEL;
+		uint64_t packed = 0;
+		uint32_t shift = 0;
+		uint32_t finishedIndex = 0;
+		for (uint32_t i = 0; i < slotCount; ++i)
+		{
+			if (finishedIndex < finishedCount && finishedSlots[finishedIndex] == i)
+			{
+				++finishedIndex;
+				continue;
+			}
+
+			uint8_t code = codes[i];
+			if (code >= SLOT_FIRST_LABEL)
+			{
+				if (relabel[code] == 0)
+				{
+					relabel[code] = nextLabel++;
+				}
+				code = relabel[code];
+			}
+
+			packed |= (uint64_t)code << shift;
+			shift += 4;
+		}
+
+		std::unordered_map<uint64_t, int32_t>::iterator itFind = outStates.find(packed);
+		if (itFind == outStates.end())
+		{
+			outStates.emplace(packed, length);
 		}
+		else
+		{
+			itFind->second = std::max(itFind->second, length);
+		}
+	}
+
+	uint64_t GetAllNodesMask() const { return m_nodeCount == 64 ? ~0ULL : (1ULL << m_nodeCount) - 1; }
 
-		IntVec2 m_Goal;
-		std::vector<GraphWalkState> m_SolvedStates;
-		const VertVector* m_Nodes;
-		const VertAdjLengthVector* m_AdjInfo;
-		std::unordered_map<uint64_t, uint32_t> m_Cache;
+	uint32_t m_nodeCount;
+	std::vector<PendingEdge> m_pendingEdges;
+	std::vector<uint32_t> m_edgeOffsets;
+	std::vector<uint32_t> m_edgeTargets;
+	std::vector<int32_t> m_edgeLengths;
+	std::vector<uint64_t> m_neighborMask;
+	std::vector<int32_t> m_maxIncoming;
+};
+
+constexpr int32_t LongestPathSolver::NO_PATH;
+
+class AdventDay : public AdventGUIInstance
+{
+public:
+	AdventDay(const AdventGUIParams& params)
+		: AdventGUIInstance(params), m_MapWidth(0), m_MapHeight(0)
+	{};
+private:
+	struct Vert
+	{
+		Vert(const IntVec2& _pos):pos(_pos), connections{ nullptr }, numConnections(0) {};
+		Vert():pos(0), connections{nullptr}, numConnections(0) {};
+
+		void Connect(const Vert* to)
+		{
+			assert(numConnections < 4);
+			connections[numConnections++] = to;
+		}
+
+		const Vert* connections[4];
+		uint8_t numConnections;
+		IntVec2 pos;
 	};
 
+	typedef std::vector<std::vector<std::pair<int32_t, int32_t>>> VertAdjLengthVector;
+
 	struct WalkState
 	{
 		WalkState(const IntVec2& _pos, const IntVec2& _dir, const std::unordered_set<IntVec2>& _stepHistory):pos(_pos), dir(_dir), stepHistory(_stepHistory), hash(0)
@@ -444,13 +918,22 @@ private:
 	virtual void PartTwo(const AdventGUIContext& context) override
 	{	
 		// Part Two
-		GraphWalkExecuter graphExec(&m_condensedNodes, &m_vertAdjAndLength, IntVec2((int32_t)m_MapWidth - 2, (int32_t)m_MapHeight - 1));
+		const IntVec2 goalPos((int32_t)m_MapWidth - 2, (int32_t)m_MapHeight - 1);
+		std::vector<const Vert*>::const_iterator itGoal = std::find_if(m_condensedNodes.begin(), m_condensedNodes.end(), [&](const Vert* LHS) { return LHS->pos == goalPos; });
+		assert(itGoal != m_condensedNodes.end());
 
-		graphExec.Solve();
-
-		std::sort(graphExec.m_SolvedStates.begin(), graphExec.m_SolvedStates.end(), [](const GraphWalkState& LHS, const GraphWalkState& RHS){ return LHS.totalSteps > RHS.totalSteps; });
+		LongestPathSolver solver((uint32_t)m_condensedNodes.size());
+		for (size_t i = 0; i < m_vertAdjAndLength.size(); ++i)
+		{
+			for (const std::pair<int32_t, int32_t>& kvp : m_vertAdjAndLength[i])
+			{
+				solver.AddEdge((uint32_t)i, (uint32_t)kvp.first, kvp.second);
+			}
+		}
+		solver.Build();
 
-		Log("Most Steps: %u", graphExec.m_SolvedStates[0].totalSteps);
+		// Node 0 is always the entrance, it's the first vert we discover.
+		Log("Most Steps: %d", solver.Solve(0, (uint32_t)(itGoal - m_condensedNodes.begin())));
 
 		// Done.
 		AdventGUIInstance::PartTwo(context);
@@ -6,12 +6,470 @@
 #include "ACUtils/Algorithm.h"
 #include "ACUtils/IntVec.h"
 #include "ACUtils/Hash.h"
+#include "ACUtils/Int128.h"
+#include "ACUtils/Intercept.h"
 #include "ACUtils/AABB.h"
+#include "ACUtils/Parallel.h"
 #include "ACUtils/StringUtil.h"
+#include <cmath>
+#include <inttypes.h>
 #include <vector>
 #include <queue>
 #include <unordered_set>
-#include "z3++.h"
+
+// Counts pairs of XY paths that cross inside a test area, exactly.
+// Every path gets clipped to the area first (parameter range as exact fractions). If any path starts inside the area, the area is
+// split into a uniform grid of cells, and each cell counts only the crossings it owns (cells are half open, except along the area's
+// max edges). Inside a cell, each path clips down to a segment again. Segments that run boundary to boundary are chords, and two
+// chords of a convex area cross iff their ends interleave going around the perimeter, so those get counted with one sorted walk
+// of the perimeter and a Fenwick tree. A path that starts inside the area only does that inside one cell, so it gets tested pairwise
+// with exact 128 bit predicates against just that cell's segments. So do chords that share a perimeter point or run along an edge.
+// Positions need to stay within +/- 2^52 and velocities within +/- 2^20 for the products to fit.
+class HailCrossingCounter
+{
+public:
+	HailCrossingCounter(const Int64AABB2D& area) : m_area(area) {}
+
+	void AddPath(const Int64Vec2& pos, const Int64Vec2& dir)
+	{
+		Segment segment;
+		if (Clip(pos, dir, m_area, segment))
+		{
+			m_segments.push_back(segment);
+		}
+	}
+
+	uint64_t CountCrossings() const
+	{
+		// Only paths that start inside the area need the grid, everything else is a chord of the whole area.
+		size_t interiorStarts = 0;
+		for (const Segment& segment : m_segments)
+		{
+			interiorStarts += MakePerimeterPoint(m_area, segment, segment.enter, 0).edge == INTERIOR ? 1 : 0;
+		}
+
+		// Cells hold about n / G segments each, so the interior starts cost roughly n^2 / G pairwise tests, and the chords
+		// cost n * G cell visits.
+		const uint32_t gridSize = interiorStarts == 0 ? 1 : std::min(std::max((uint32_t)std::sqrt((double)m_segments.size()) / 2, 1U), MAX_GRID_SIZE);
+		std::vector<int64_t> columnBounds;
+		std::vector<int64_t> rowBounds;
+		MakeGridBounds(m_area.GetMin().x, m_area.GetMax().x, gridSize, columnBounds);
+		MakeGridBounds(m_area.GetMin().y, m_area.GetMax().y, gridSize, rowBounds);
+		const uint32_t columnCount = (uint32_t)columnBounds.size() - 1;
+		const uint32_t rowCount = (uint32_t)rowBounds.size() - 1;
+
+		std::vector<uint64_t> workerCrossings(Parallel::GetWorkerCount(columnCount), 0);
+		Parallel::ForEach(columnCount, [&](uint32_t workerIndex, size_t column)
+		{
+			const double columnMin = (double)columnBounds[column];
+			const double columnMax = (double)columnBounds[column + 1];
+
+			// Bucket by row. These use the padded double bounds, a segment landing in a cell it doesn't actually reach just
+			// clips away to nothing there.
+			std::vector<std::vector<uint32_t>> cellSegments(rowCount);
+			for (uint32_t i = 0; i < (uint32_t)m_segments.size(); ++i)
+			{
+				const Segment& segment = m_segments[i];
+				const double xMin = std::max(segment.boundsMin[0], columnMin);
+				const double xMax = std::min(segment.boundsMax[0], columnMax);
+				if (xMin > xMax)
+				{
+					continue;
+				}
+
+				double yMin = segment.boundsMin[1];
+				double yMax = segment.boundsMax[1];
+				if (segment.dir.x != 0)
+				{
+					const double yA = (double)segment.pos.y + (double)segment.dir.y * ((xMin - (double)segment.pos.x) / (double)segment.dir.x);
+					const double yB = (double)segment.pos.y + (double)segment.dir.y * ((xMax - (double)segment.pos.x) / (double)segment.dir.x);
+					const double pad = 1.0 + std::max(std::abs(yA), std::abs(yB)) * 1e-9;
+					yMin = std::max(yMin, std::min(yA, yB) - pad);
+					yMax = std::min(yMax, std::max(yA, yB) + pad);
+				}
+
+				const uint32_t firstRow = GetGridIndex(rowBounds, yMin);
+				const uint32_t lastRow = GetGridIndex(rowBounds, yMax);
+				for (uint32_t row = firstRow; row <= lastRow; ++row)
+				{
+					cellSegments[row].push_back(i);
+				}
+			}
+
+			uint64_t crossings = 0;
+			for (uint32_t row = 0; row < rowCount; ++row)
+			{
+				if (cellSegments[row].size() < 2)
+				{
+					continue;
+				}
+
+				const Int64AABB2D cell(Int64Vec2(columnBounds[column], rowBounds[row]), Int64Vec2(columnBounds[column + 1], rowBounds[row + 1]));
+				crossings += CountCellCrossings(cell, column + 1 == columnCount, row + 1 == rowCount, cellSegments[row]);
+			}
+			workerCrossings[workerIndex] += crossings;
+		});
+
+		uint64_t total = 0;
+		for (uint64_t crossings : workerCrossings)
+		{
+			total += crossings;
+		}
+		return total;
+	}
+
+private:
+	// num / den, den > 0. A den of 0 stands in for infinity.
+	struct Fraction
+	{
+		int64_t num;
+		int64_t den;
+	};
+
+	struct Segment
+	{
+		Int64Vec2 pos;
+		Int64Vec2 dir;
+		Fraction enter;
+		Fraction exit;
+		double boundsMin[2]; // Slightly padded bounds, only used to skip the exact test for pairs that can't possibly touch.
+		double boundsMax[2];
+	};
+
+	// Perimeter runs counter clockwise from the min corner: bottom, right, top, left. Each corner belongs to the edge it starts.
+	enum PerimeterEdge : uint8_t
+	{
+		BOTTOM = 0,
+		RIGHT,
+		TOP,
+		LEFT,
+		INTERIOR,
+	};
+
+	struct PerimeterPoint
+	{
+		Int128 along; // Distance along the edge times den, so it increases going around the perimeter.
+		int64_t den;
+		uint32_t segment;
+		PerimeterEdge edge;
+	};
+
+	// Cells per axis, past this the chords spend more time visiting cells than the pairwise tests save.
+	static constexpr uint32_t MAX_GRID_SIZE = 256;
+
+	// The part of pos + dir * t, t >= 0, inside area. False if there isn't any.
+	static bool Clip(const Int64Vec2& pos, const Int64Vec2& dir, const Int64AABB2D& area, Segment& outSegment)
+	{
+		if (dir.IsZero())
+		{
+			return false; // Parallel to everything, never counted.
+		}
+
+		outSegment.pos = pos;
+		outSegment.dir = dir;
+		outSegment.enter = Fraction{ 0, 1 };
+		outSegment.exit = Fraction{ 0, 0 }; // Unbounded until an axis clips it.
+
+		for (int axis = 0; axis < 2; ++axis)
+		{
+			const int64_t p = axis == 0 ? pos.x : pos.y;
+			const int64_t d = axis == 0 ? dir.x : dir.y;
+			const int64_t lo = axis == 0 ? area.GetMin().x : area.GetMin().y;
+			const int64_t hi = axis == 0 ? area.GetMax().x : area.GetMax().y;
+			if (d == 0)
+			{
+				if (p < lo || p > hi)
+				{
+					return false;
+				}
+				continue;
+			}
+
+			const Fraction axisEnter = d > 0 ? Fraction{ lo - p, d } : Fraction{ p - hi, -d };
+			const Fraction axisExit = d > 0 ? Fraction{ hi - p, d } : Fraction{ p - lo, -d };
+			if (Compare(axisEnter, outSegment.enter) > 0)
+			{
+				outSegment.enter = axisEnter;
+			}
+			if (outSegment.exit.den == 0 || Compare(axisExit, outSegment.exit) < 0)
+			{
+				outSegment.exit = axisExit;
+			}
+		}
+
+		if (Compare(outSegment.enter, outSegment.exit) > 0)
+		{
+			return false; // Never in the area going forward.
+		}
+
+		for (int axis = 0; axis < 2; ++axis)
+		{
+			const double p = (double)(axis == 0 ? pos.x : pos.y);
+			const double d = (double)(axis == 0 ? dir.x : dir.y);
+			const double a = p + d * ((double)outSegment.enter.num / (double)outSegment.enter.den);
+			const double b = p + d * ((double)outSegment.exit.num / (double)outSegment.exit.den);
+			const double pad = 1.0 + std::max(std::abs(a), std::abs(b)) * 1e-9;
+			outSegment.boundsMin[axis] = std::min(a, b) - pad;
+			outSegment.boundsMax[axis] = std::max(a, b) + pad;
+		}
+
+		return true;
+	}
+
+	// cellCount + 1 integer bounds from lo to hi. The last cell soaks up the remainder.
+	static void MakeGridBounds(int64_t lo, int64_t hi, uint32_t cellCount, std::vector<int64_t>& outBounds)
+	{
+		const int64_t range = hi - lo;
+		cellCount = (uint32_t)std::max(std::min((int64_t)cellCount, range), (int64_t)1);
+		const int64_t step = std::max(range / cellCount, (int64_t)1);
+
+		outBounds.clear();
+		for (uint32_t i = 0; i < cellCount; ++i)
+		{
+			outBounds.push_back(lo + step * i);
+		}
+		outBounds.push_back(hi);
+	}
+
+	static uint32_t GetGridIndex(const std::vector<int64_t>& bounds, double value)
+	{
+		const uint32_t cellCount = (uint32_t)bounds.size() - 1;
+		const double step = (double)(bounds[1] - bounds[0]);
+		const double cell = std::floor((value - (double)bounds[0]) / step);
+		return (uint32_t)std::min(std::max(cell, 0.0), (double)(cellCount - 1));
+	}
+
+	static int32_t Compare(const Fraction& LHS, const Fraction& RHS)
+	{
+		return (Int128::Multiply(LHS.num, RHS.den) - Int128::Multiply(RHS.num, LHS.den)).Sign();
+	}
+
+	static int32_t ComparePerimeter(const PerimeterPoint& LHS, const PerimeterPoint& RHS)
+	{
+		if (LHS.edge != RHS.edge)
+		{
+			return LHS.edge < RHS.edge ? -1 : 1;
+		}
+		return (LHS.along * Int128(RHS.den) - RHS.along * Int128(LHS.den)).Sign();
+	}
+
+	static PerimeterPoint MakePerimeterPoint(const Int64AABB2D& area, const Segment& segment, const Fraction& t, uint32_t segmentIndex)
+	{
+		// Point is (pos * den + dir * num) / den, kept as numerators.
+		const Int128 den(t.den);
+		const Int128 x = Int128::Multiply(segment.pos.x, t.den) + Int128::Multiply(segment.dir.x, t.num);
+		const Int128 y = Int128::Multiply(segment.pos.y, t.den) + Int128::Multiply(segment.dir.y, t.num);
+		const Int128 minX = Int128(area.GetMin().x) * den;
+		const Int128 minY = Int128(area.GetMin().y) * den;
+		const Int128 maxX = Int128(area.GetMax().x) * den;
+		const Int128 maxY = Int128(area.GetMax().y) * den;
+
+		PerimeterPoint point;
+		point.den = t.den;
+		point.segment = segmentIndex;
+		if (y == minY && x < maxX)
+		{
+			point.edge = BOTTOM;
+			point.along = x - minX;
+		}
+		else if (x == maxX && y < maxY)
+		{
+			point.edge = RIGHT;
+			point.along = y - minY;
+		}
+		else if (y == maxY && x > minX)
+		{
+			point.edge = TOP;
+			point.along = maxX - x;
+		}
+		else if (x == minX && y > minY)
+		{
+			point.edge = LEFT;
+			point.along = maxY - y;
+		}
+		else
+		{
+			point.edge = INTERIOR;
+		}
+		return point;
+	}
+
+	// Crossings owned by one cell, between the paths in pathIndices. closedX / closedY say whether the cell also owns its max edges.
+	uint64_t CountCellCrossings(const Int64AABB2D& cell, bool closedX, bool closedY, const std::vector<uint32_t>& pathIndices) const
+	{
+		std::vector<Segment> segments;
+		segments.reserve(pathIndices.size());
+		for (uint32_t path : pathIndices)
+		{
+			Segment segment;
+			if (Clip(m_segments[path].pos, m_segments[path].dir, cell, segment))
+			{
+				segments.push_back(segment);
+			}
+		}
+
+		// Sort out which segments are chords and where their ends sit on the perimeter.
+		std::vector<PerimeterPoint> ends;
+		std::vector<bool> isChord(segments.size(), true);
+		for (uint32_t i = 0; i < (uint32_t)segments.size(); ++i)
+		{
+			const Segment& segment = segments[i];
+			const PerimeterPoint start = MakePerimeterPoint(cell, segment, segment.enter, i);
+			const PerimeterPoint end = MakePerimeterPoint(cell, segment, segment.exit, i);
+
+			// Starting inside, or lying along an edge (or just touching a corner), doesn't interleave cleanly. Neither does anything
+			// in a zero sized area, where even the exit doesn't land on an edge.
+			const bool alongEdge = (segment.dir.x == 0 && (segment.pos.x == cell.GetMin().x || segment.pos.x == cell.GetMax().x)) ||
+				(segment.dir.y == 0 && (segment.pos.y == cell.GetMin().y || segment.pos.y == cell.GetMax().y));
+			if (start.edge == INTERIOR || end.edge == INTERIOR || start.edge == end.edge || alongEdge)
+			{
+				isChord[i] = false;
+				continue;
+			}
+
+			ends.push_back(start);
+			ends.push_back(end);
+		}
+
+		std::sort(ends.begin(), ends.end(), [&](const PerimeterPoint& LHS, const PerimeterPoint& RHS) { return ComparePerimeter(LHS, RHS) < 0; });
+
+		// Chords sharing a perimeter point (touching ends, collinear paths, corner grazes) don't either, test those directly.
+		for (size_t i = 1; i < ends.size(); ++i)
+		{
+			if (ComparePerimeter(ends[i - 1], ends[i]) == 0)
+			{
+				isChord[ends[i - 1].segment] = false;
+				isChord[ends[i].segment] = false;
+			}
+		}
+
+		std::vector<uint32_t> chords;
+		std::vector<uint32_t> pairwise;
+		for (uint32_t i = 0; i < (uint32_t)segments.size(); ++i)
+		{
+			(isChord[i] ? chords : pairwise).push_back(i);
+		}
+
+		// Crossings between two chords are strictly inside the cell, so always ours.
+		uint64_t crossings = CountChordCrossings(ends, isChord);
+		for (size_t i = 0; i < pairwise.size(); ++i)
+		{
+			const Segment& segment = segments[pairwise[i]];
+			for (size_t j = i + 1; j < pairwise.size(); ++j)
+			{
+				crossings += Crosses(segment, segments[pairwise[j]], cell, closedX, closedY) ? 1 : 0;
+			}
+			for (uint32_t chord : chords)
+			{
+				crossings += Crosses(segment, segments[chord], cell, closedX, closedY) ? 1 : 0;
+			}
+		}
+		return crossings;
+	}
+
+	// Walk the perimeter, and when a chord closes count the still open chords that opened inside it. Those interleave with it.
+	static uint64_t CountChordCrossings(const std::vector<PerimeterPoint>& ends, const std::vector<bool>& isChord)
+	{
+		std::vector<uint32_t> openedAt(isChord.size(), ~0U);
+		std::vector<uint32_t> fenwick(ends.size() + 1, 0);
+		auto fenwickAdd = [&](uint32_t index, int32_t delta)
+		{
+			for (uint32_t i = index + 1; i < fenwick.size(); i += i & (0U - i))
+			{
+				fenwick[i] += delta;
+			}
+		};
+		auto fenwickPrefix = [&](uint32_t count)
+		{
+			uint32_t sum = 0;
+			for (uint32_t i = count; i > 0; i &= i - 1)
+			{
+				sum += fenwick[i];
+			}
+			return sum;
+		};
+
+		uint64_t crossings = 0;
+		for (uint32_t position = 0; position < (uint32_t)ends.size(); ++position)
+		{
+			const uint32_t segment = ends[position].segment;
+			if (!isChord[segment])
+			{
+				continue;
+			}
+
+			if (openedAt[segment] == ~0U)
+			{
+				openedAt[segment] = position;
+				fenwickAdd(position, 1);
+			}
+			else
+			{
+				fenwickAdd(openedAt[segment], -1);
+				crossings += fenwickPrefix(position) - fenwickPrefix(openedAt[segment] + 1);
+			}
+		}
+		return crossings;
+	}
+
+	// pos + dir * t == other.pos + other.dir * u with both parameters inside their clipped ranges, and the point owned by cell.
+	// Parallel paths never count.
+	static bool Crosses(const Segment& LHS, const Segment& RHS, const Int64AABB2D& cell, bool closedX, bool closedY)
+	{
+		if (LHS.boundsMin[0] > RHS.boundsMax[0] || RHS.boundsMin[0] > LHS.boundsMax[0] || LHS.boundsMin[1] > RHS.boundsMax[1] || RHS.boundsMin[1] > LHS.boundsMax[1])
+		{
+			return false;
+		}
+
+		int64_t det = LHS.dir.x * RHS.dir.y - LHS.dir.y * RHS.dir.x;
+		if (det == 0)
+		{
+			return false;
+		}
+
+		const int64_t wx = RHS.pos.x - LHS.pos.x;
+		const int64_t wy = RHS.pos.y - LHS.pos.y;
+		Int128 t = Int128::Multiply(wx, RHS.dir.y) - Int128::Multiply(wy, RHS.dir.x);
+		Int128 u = Int128::Multiply(wx, LHS.dir.y) - Int128::Multiply(wy, LHS.dir.x);
+		if (det < 0)
+		{
+			det = -det;
+			t = -t;
+			u = -u;
+		}
+
+		if (!InRange(t, det, LHS.enter, LHS.exit) || !InRange(u, det, RHS.enter, RHS.exit))
+		{
+			return false;
+		}
+
+		// Crossing point is (pos * det + dir * t) / det.
+		const Int128 x = Int128::Multiply(LHS.pos.x, det) + Int128(LHS.dir.x) * t;
+		const Int128 y = Int128::Multiply(LHS.pos.y, det) + Int128(LHS.dir.y) * t;
+		return OwnsCoordinate(x, det, cell.GetMin().x, cell.GetMax().x, closedX) && OwnsCoordinate(y, det, cell.GetMin().y, cell.GetMax().y, closedY);
+	}
+
+	static bool OwnsCoordinate(const Int128& num, int64_t den, int64_t lo, int64_t hi, bool closed)
+	{
+		const Int128 scaledHi = Int128::Multiply(hi, den);
+		return num >= Int128::Multiply(lo, den) && (closed ? num <= scaledHi : num < scaledHi);
+	}
+
+	static bool InRange(const Int128& num, int64_t den, const Fraction& lo, const Fraction& hi)
+	{
+		const Int128 scaled = num * Int128(lo.den);
+		if (scaled < Int128::Multiply(lo.num, den))
+		{
+			return false;
+		}
+		return num * Int128(hi.den) <= Int128::Multiply(hi.num, den);
+	}
+
+	Int64AABB2D m_area;
+	std::vector<Segment> m_segments;
+};
+
+constexpr uint32_t HailCrossingCounter::MAX_GRID_SIZE;
 
 class AdventDay : public AdventGUIInstance
 {
@@ -59,61 +517,16 @@ private:
 		}
 	}
 
-	bool RayToRayXY(const Hail& LHS, const Hail& RHS, double& outIntersectX, double& outIntersectY) const
-	{
-		int64_t dx = RHS.Pos.x - LHS.Pos.x;
-		int64_t dy = RHS.Pos.y - LHS.Pos.y;
-		int64_t det = RHS.Dir.x * LHS.Dir.y - RHS.Dir.y * LHS.Dir.x;
-
-		if (det != 0 )
-		{
-			double u = (double)(dy * RHS.Dir.x - dx * RHS.Dir.y) / (double)det;
-			double v = (double)(dy * LHS.Dir.x - dx * LHS.Dir.y) / (double)det;
-
-			if (u >= 0 && v >= 0)
-			{
-				double posX = (double)LHS.Pos.x;
-				double posY = (double)LHS.Pos.y;
-				double dirX = (double)LHS.Dir.x * u;
-				double dirY = (double)LHS.Dir.y * u;
-
-				outIntersectX = posX + dirX;
-				outIntersectY = posY + dirY;
-
-				return true;
-			}
-		}
-
-		return false;
-	}
-
 	virtual void PartOne(const AdventGUIContext& context) override
 	{
 		// Part One
-		Int64AABB2D testArea(Int64Vec2(200000000000000LL), Int64Vec2(400000000000000LL));
-
-		double collX = 0.0;
-		double collY = 0.0;
-
-		uint32_t totalHits = 0;
-
-		for (size_t i = 0; i < m_Hail.size() - 1; ++i)
+		HailCrossingCounter counter(Int64AABB2D(Int64Vec2(200000000000000LL), Int64Vec2(400000000000000LL)));
+		for (const Hail& hail : m_Hail)
 		{
-			const Hail& LHS = m_Hail[i];
-			for (size_t j = i + 1; j < m_Hail.size(); ++j)
-			{
-				const Hail& RHS = m_Hail[j];
-				if (RayToRayXY(LHS, RHS, collX, collY))
-				{
-					if (testArea.Contains(Int64Vec2((int64_t)collX, (int64_t)collY)))
-					{
-						++totalHits;
-					}
-				}
-			}
+			counter.AddPath(Int64Vec2(hail.Pos.x, hail.Pos.y), Int64Vec2(hail.Dir.x, hail.Dir.y));
 		}
 
-		Log("Total Hits: %u", totalHits);
+		Log("Total Hits: %" PRIu64, counter.CountCrossings());
 
 		// Done.
 		AdventGUIInstance::PartOne(context);
@@ -122,47 +535,27 @@ private:
 	virtual void PartTwo(const AdventGUIContext& context) override
 	{	
 		// Part Two
-		z3::context solverContext;
-		z3::solver solver(solverContext);
-
 		// For this we need to find out a Pos xyz and Velocity xyz that at time (t) equals:
-		// pos.x + vel.x * t = hailPos.x + hailVel.x * t
-		// pos.y + vel.y * t = hailPos.y + hailVel.y * t
-		// pos.z + vel.z * t = hailPos.z + hailVel.z * t
-
-		z3::expr px = solverContext.int_const("px");
-		z3::expr py = solverContext.int_const("py");
-		z3::expr pz = solverContext.int_const("pz");
-		z3::expr vx = solverContext.int_const("vx");
-		z3::expr vy = solverContext.int_const("vy");
-		z3::expr vz = solverContext.int_const("vz");
-
-		for (size_t i = 0; i < 3; ++i)
+		// pos + vel * t = hailPos + hailVel * t
+		std::vector<Int64Vec3> positions;
+		std::vector<Int64Vec3> velocities;
+		for (const Hail& hail : m_Hail)
 		{
-			const Hail& current = m_Hail[i];
-			z3::expr t = solverContext.int_const("t" + ('0' + i));
-			z3::expr hx = solverContext.int_val(current.Pos.x);
-			z3::expr hy = solverContext.int_val(current.Pos.y);
-			z3::expr hz = solverContext.int_val(current.Pos.z);
-
-			z3::expr hvx = solverContext.int_val(current.Dir.x);
-			z3::expr hvy = solverContext.int_val(current.Dir.y);
-			z3::expr hvz = solverContext.int_val(current.Dir.z);
-
-			solver.add(t > 0);
-			solver.add(hx + t * hvx == px + t * vx);
-			solver.add(hy + t * hvy == py + t * vy);
-			solver.add(hz + t * hvz == pz + t * vz);
+			positions.push_back(hail.Pos);
+			velocities.push_back(hail.Dir);
 		}
 
-		z3::check_result rslt = solver.check();
-		z3::model mdl = solver.get_model();
-
-		z3::expr evalX = mdl.eval(px);
-		z3::expr evalY = mdl.eval(py);
-		z3::expr evalZ = mdl.eval(pz);
+		Int64Vec3 rockPos;
+		Int64Vec3 rockVel;
+		if (Intercept::FindThrowThroughAll(positions, velocities, rockPos, rockVel))
+		{
+			Log("%lld", rockPos.x + rockPos.y + rockPos.z);
+		}
+		else
+		{
+			Log("No throw hits every hailstone.");
+		}
 
-		Log("%lld", evalX.as_int64() + evalY.as_int64() + evalZ.as_int64());
 		// Done.
 		AdventGUIInstance::PartTwo(context);
 	}
@@ -3,10 +3,12 @@
 
 #include "AdventGUI/AdventGUI.h"
 
+#include "ACUtils/Math.h"
 #include "ACUtils/StringUtil.h"
 #include <algorithm>
 #include <vector>
 #include <cctype>
+#include <inttypes.h>
 
 class AdventDay : public AdventGUIInstance
 {
@@ -54,54 +56,16 @@ private:
 		}
 	}
 
-	void FindSolutions(uint64_t time, uint64_t distanceToBeat, std::vector<uint64_t>& outResults)
-	{
-		uint64_t runDistance = 0;
-		for (uint64_t i = 1; i < time; ++i)
-		{
-			runDistance = (time - i) * i;
-			if (runDistance > distanceToBeat)
-			{
-				outResults.emplace_back(i);
-
-				//Log("For Time [%u] with [%u] distance. Holding for [%u] seconds WILL win with a distance of [%u].", time, distanceToBeat, i, runDistance);
-			}
-			else
-			{
-				//Log("For Time [%u] with [%u] distance. Holding for [%u] seconds WILL NOT win. Distance [%u].", time, distanceToBeat, i, runDistance);
-			}
-		}
-	}
-
-
-	uint64_t FindSolutions(uint64_t time, uint64_t distanceToBeat)
-	{
-		uint64_t runDistance = 0;
-		for (uint64_t i = 1; i < time; ++i)
-		{
-			runDistance = (time - i) * i;
-			if (runDistance > distanceToBeat)
-			{
-				return runDistance - (i * 2) + 1;
-			}
-		}
-
-		return 0;
-	}
-
 	virtual void PartOne(const AdventGUIContext& context) override
 	{
 		// Part One
 		uint64_t sum = 1;
-		std::vector<uint64_t> validTimes;
 		for (size_t i = 0; i < m_Time.size() - 1; ++i)
 		{
-			validTimes.clear();
-			FindSolutions(m_Time[i], m_Distance[i], validTimes);
-			sum *= (uint64_t)std::max((uint64_t)validTimes.size(), 1ULL);
+			sum *= std::max(Math::CountProductsAbove(m_Time[i], m_Distance[i]), (uint64_t)1);
 		}
 
-		Log("Product of Valid Options: %u", sum);
+		Log("Product of Valid Options: %" PRIu64, sum);
 
 		// Done.
 		AdventGUIInstance::PartOne(context);
@@ -110,11 +74,8 @@ private:
 	virtual void PartTwo(const AdventGUIContext& context) override
 	{
 		// Part Two
-		std::vector<uint64_t> validTimes;
-		FindSolutions(m_Time.back(), m_Distance.back(), validTimes);
-		uint64_t otherSolution = FindSolutions(m_Time.back(), m_Distance.back());
-
-		Log("Valid Solutions: %zd", validTimes.size());
+		// Holding for i out of T goes i * (T - i), closed form beats checking every hold time.
+		Log("Valid Solutions: %" PRIu64, Math::CountProductsAbove(m_Time.back(), m_Distance.back()));
 
 		// Done.
 		AdventGUIInstance::PartTwo(context);
@@ -4,12 +4,12 @@
 #include "AdventGUI/AdventGUI.h"
 
 #include "ACUtils/Algorithm.h"
-#include "ACUtils/Bit.h"
 #include "ACUtils/Math.h"
 #include "ACUtils/StringUtil.h"
 #include <algorithm>
 #include <vector>
 #include <cctype>
+#include <inttypes.h>
 
 class AdventDay : public AdventGUIInstance
 {
@@ -31,118 +31,83 @@ private:
 		HR_TotalResults
 	};
 
-	static constexpr const char* HandResultAsString[] = 
-	{
-		"None",
-		"High Card",
-		"One Pair",
-		"Two Pair",
-		"Three of a Kind",
-		"Full House",
-		"Four of a Kind",
-		"Five of a Kind"
-	};
-
+	// Everything a sort needs, packed into one uint32_t: hand type in bits 20-22, then the five card ranks, 4 bits each,
+	// first card highest. Comparing keys compares hands.
 	struct Hand
 	{
-		char cards[5];
-		uint32_t cardBits;
-		HandResult result;
+		uint32_t key;
+		uint32_t jokerKey; // Same, but jacks are jokers.
 		uint32_t bet;
 	};
 
-	static constexpr char s_validChars[] = { '2', '3', '4', '5', '6', '7', '8', '9', 'T', 'J', 'Q', 'K', 'A' };
+	static constexpr uint32_t CARDS_PER_HAND = 5;
+	static constexpr uint32_t BITS_PER_CARD = 4;
+	static constexpr uint32_t RESULT_SHIFT = CARDS_PER_HAND * BITS_PER_CARD;
+	static constexpr uint32_t KEY_BITS = RESULT_SHIFT + 3;
+	static constexpr uint8_t INVALID_CARD = 0xFF;
+	static constexpr uint8_t CARD_TYPES = 13; // 2-9, T, J, Q, K, A
+	static constexpr uint8_t JACK = 9;
+
 	static uint8_t GetCharacterValue(char c)
 	{
-		if (!isdigit(c))
+		switch (c)
 		{
-			switch (c)
-			{
-				case 'T': return 8;
-				case 'J': return 9;
-				case 'Q': return 10;
-				case 'K': return 11;
-				case 'A': return 12;
-				default: assert(false);
-			}
+			case 'T': return 8;
+			case 'J': return JACK;
+			case 'Q': return 10;
+			case 'K': return 11;
+			case 'A': return 12;
+			default: return isdigit(c) && c >= '2' ? (uint8_t)(c - '2') : INVALID_CARD;
 		}
-
-		return c - '2';
 	}
-	HandResult EvaluateHand(const Hand& hand) const
-	{
-		HandResult outResult = HandResult::HR_None;
-		uint8_t evalBuffer[ARRAY_SIZE(s_validChars)] = { 0 };
-		uint32_t popCnt = Bits::PopCount32(hand.cardBits);
 
-		// Few simple cases.
-		
-		switch (popCnt)
+	// Only the biggest group and the number of distinct cards matter.
+	static HandResult ClassifyHand(uint8_t largestGroup, uint8_t distinctCards)
+	{
+		switch (distinctCards)
 		{
-			case 1:	{ outResult = HandResult::HR_FiveOfAKind; } break;
-			case 2:
-			case 3:
-			{
-				// Could be Four of a kind, three of a kind, full house, or two pairs
-				for (char c : hand.cards)
-				{
-					++evalBuffer[GetCharacterValue(c)];
-				}
+			case 1: return HandResult::HR_FiveOfAKind;
+			case 2: return largestGroup == 4 ? HandResult::HR_FourOfAKind : HandResult::HR_FullHouse;
+			case 3: return largestGroup == 3 ? HandResult::HR_ThreeOfAKind : HandResult::HR_TwoPair;
+			case 4: return HandResult::HR_OnePair;
+			case 5: return HandResult::HR_HighCard;
+			default: assert(false); return HandResult::HR_None;
+		}
+	}
 
-				for (size_t i = 0; i < ARRAY_SIZE(evalBuffer); ++i)
-				{
-					if (evalBuffer[i] < 2)
-					{
-						continue;
-					}
+	// Builds both sort keys. Jokers always do best joining the biggest group of real cards, and rank below a 2.
+	static void EncodeHand(const std::string& cards, Hand& outHand)
+	{
+		assert(cards.size() == CARDS_PER_HAND);
 
-					if (evalBuffer[i] == 4)
-					{
-						outResult = HandResult::HR_FourOfAKind;
-						break;
-					}
-					else if (evalBuffer[i] == 3)
-					{
-						outResult = HandResult::HR_ThreeOfAKind;
-						for (size_t j = i + 1; j < ARRAY_SIZE(evalBuffer); ++j)
-						{
-							if (evalBuffer[j] == 2)
-							{
-								outResult = HandResult::HR_FullHouse;
-								break;
-							}
-						}
-						break;
+		uint8_t counts[CARD_TYPES] = { 0 };
+		uint32_t ranks = 0;
+		uint32_t jokerRanks = 0;
+		for (char c : cards)
+		{
+			const uint8_t value = GetCharacterValue(c);
+			assert(value != INVALID_CARD);
+			++counts[value];
 
-					}
-					else if (evalBuffer[i] == 2)
-					{
-						outResult = HandResult::HR_OnePair;
-						for (size_t j = i + 1; j < ARRAY_SIZE(evalBuffer); ++j)
-						{
-							if (evalBuffer[j] == 2)
-							{
-								outResult = HandResult::HR_TwoPair;
-								break;
-							}
-							else if (evalBuffer[j] == 3)
-							{
-								outResult = HandResult::HR_FullHouse;
-								break;
-							}
-						}
-					}
+			ranks = (ranks << BITS_PER_CARD) | value;
+			jokerRanks = (jokerRanks << BITS_PER_CARD) | (value == JACK ? 0 : (value < JACK ? value + 1 : value));
+		}
 
-					break;
-				}
-			}
-			break;
-			case 4: { outResult = HandResult::HR_OnePair; } break;
-			case 5: { outResult = HandResult::HR_HighCard;} break;
-			default: assert(false);
+		uint8_t largestGroup = 0;
+		uint8_t largestGroupSansJokers = 0;
+		uint8_t distinctCards = 0;
+		for (uint8_t card = 0; card < CARD_TYPES; ++card)
+		{
+			largestGroup = std::max(largestGroup, counts[card]);
+			largestGroupSansJokers = card == JACK ? largestGroupSansJokers : std::max(largestGroupSansJokers, counts[card]);
+			distinctCards += counts[card] != 0 ? 1 : 0;
 		}
 
-		return outResult;
+		const uint8_t jokers = counts[JACK];
+		const uint8_t distinctSansJokers = (uint8_t)std::max(distinctCards - (jokers != 0 ? 1 : 0), 1);
+
+		outHand.key = ((uint32_t)ClassifyHand(largestGroup, distinctCards) << RESULT_SHIFT) | ranks;
+		outHand.jokerKey = ((uint32_t)ClassifyHand((uint8_t)(largestGroupSansJokers + jokers), distinctSansJokers) << RESULT_SHIFT) | jokerRanks;
 	}
 
 	virtual void ParseInput(FileStreamReader& fileReader) override
@@ -153,184 +118,53 @@ private:
 		while (!fileReader.IsEOF())
 		{
 			line = fileReader.ReadLine();
+			if (line.empty())
+			{
+				continue;
+			}
+
 			StringUtil::SplitBy(line, " ", tokens);
 			assert(tokens.size() == 2);
 
 			Hand newHand;
-			assert(tokens[0].size() == 5);
-			memcpy((void*)newHand.cards, tokens[0].c_str(), tokens[0].size());
+			EncodeHand(tokens[0], newHand);
 			newHand.bet = atoi(tokens[1].c_str());
-			newHand.cardBits = 0;
-			for (char c : newHand.cards)
-			{
-				newHand.cardBits |= 1 << GetCharacterValue(c);
-			}
-			newHand.result = EvaluateHand(newHand);
 			m_Hands.push_back(newHand);
 		}
 	}
 
-	struct CompareHandPred  
+	// Radix sorts the hands by whichever key, then every hand wins its bet times its rank.
+	template<typename KeyFunc>
+	uint64_t GetTotalWinnings(KeyFunc getKey) const
 	{
-		CompareHandPred(bool withJokers = false) : m_WithJokers(withJokers) {}
+		std::vector<Hand> rankedHands = m_Hands;
+		Algorithm::radix_sort_by_key(rankedHands, getKey, KEY_BITS);
 
-		bool operator()(const Hand& LHS, const Hand& RHS) const
+		uint64_t sum = 0;
+		for (size_t i = 0; i < rankedHands.size(); ++i)
 		{
-			if (LHS.result == RHS.result)
-			{
-				uint8_t LHSCharValue = 0;
-				uint8_t RHSCharValue = 0;
-				for (size_t i = 0; i < ARRAY_SIZE(LHS.cards); ++i)
-				{
-					LHSCharValue = GetCharacterValue(LHS.cards[i]);
-					RHSCharValue = GetCharacterValue(RHS.cards[i]);
-					
-					if (LHSCharValue == RHSCharValue)
-					{
-						continue;
-					}
-
-					if (m_WithJokers)
-					{
-						if (LHSCharValue == 9)
-						{
-							return true;
-						}
-						
-						if (RHSCharValue == 9)
-						{
-							return false;
-						}
-					}
-
-					if (LHSCharValue != RHSCharValue)
-					{
-						return LHSCharValue < RHSCharValue;
-					}
-				}
-			}
-
-			return LHS.result < RHS.result;
+			sum += (uint64_t)rankedHands[i].bet * (i + 1);
 		}
-		bool m_WithJokers;
-	};
+		return sum;
+	}
 
 	virtual void PartOne(const AdventGUIContext& context) override
 	{
 		// Part One
-		std::sort(m_Hands.begin(), m_Hands.end(), CompareHandPred());
-
-		uint64_t sum = 0;
-		char cardBuffer[6] = {0};
-		for (size_t i = 0; i < m_Hands.size(); ++i)
-		{
-			memcpy(cardBuffer, m_Hands[i].cards, 5);
-			Log("Rank %zd: Card %s resolved to result %s with a bet of %u.", i + 1, cardBuffer, HandResultAsString[static_cast<uint32_t>(m_Hands[i].result)], m_Hands[i].bet);
-			sum += (m_Hands[i].bet * (i + 1));
-		}
+		const uint64_t sum = GetTotalWinnings([](const Hand& hand) { return hand.key; });
 
-		Log("Total Sum = %u", sum);
+		Log("Total Sum = %" PRIu64, sum);
 
 		// Done.
 		AdventGUIInstance::PartOne(context);
 	}
 
-	Hand GetOptimalHand(const Hand& originalHand)
-	{
-		Hand outHand = originalHand;
-		if (outHand.result == HandResult::HR_FiveOfAKind || ( outHand.cardBits & (1 << 9) ) == 0)
-		{
-			// No Jack / Joker, or we can't get any better.
-			return outHand;
-		}
-
-		uint16_t uniqueCardsSansJokers = Bits::PopCount32(outHand.cardBits & ~(1 << 9));
-		if (uniqueCardsSansJokers == 1)
-		{
-			outHand.result = HandResult::HR_FiveOfAKind;
-		}
-		else
-		{
-			uint8_t numCards[ARRAY_SIZE(s_validChars)] = { 0 };
-			uint8_t maxInstanceOfCards = 0;
-			uint8_t numJokers = 0;
-
-			for (char c : outHand.cards)
-			{
-				if (c == 'J')
-				{
-					++numJokers;
-				}
-				else
-				{
-					numCards[GetCharacterValue(c)]++;
-				}
-			}
-
-			for (uint8_t instanceCount : numCards)
-			{
-				maxInstanceOfCards = std::max(maxInstanceOfCards, instanceCount);
-			}
-
-			if (uniqueCardsSansJokers == 2)
-			{
-				if (originalHand.result == HandResult::HR_TwoPair)
-				{
-					outHand.result = static_cast<HandResult>(static_cast<uint8_t>(HandResult::HR_ThreeOfAKind) + numJokers);
-				}
-				else if (originalHand.result == HandResult::HR_ThreeOfAKind)
-				{
-					outHand.result = HandResult::HR_FourOfAKind;
-				}
-				else
-				{
-					assert(false);
-				}
-			}
-			else if (uniqueCardsSansJokers == 3)
-			{
-				outHand.result = (maxInstanceOfCards == 2 || numJokers == 2) ? HandResult::HR_ThreeOfAKind : HandResult::HR_TwoPair;
-			}
-			else if (uniqueCardsSansJokers == 4)
-			{
-				assert(originalHand.result == HandResult::HR_HighCard);
-				outHand.result = HandResult::HR_OnePair;
-			}
-			else
-			{
-				assert(false);
-			}
-		}
-
-		char bufferA[6] = { 0 };
-		memcpy((void*)bufferA, originalHand.cards, 5);
-		Log("Changed Hand %s with result %s to result %s", bufferA, HandResultAsString[static_cast<uint8_t>(originalHand.result)], HandResultAsString[static_cast<uint8_t>(outHand.result)]);
-		return outHand;
-	}
-
 	virtual void PartTwo(const AdventGUIContext& context) override
 	{
 		// Part Two
-		std::vector<Hand> optimalHand;
-		optimalHand.reserve(m_Hands.size());
-
-		for (const Hand& hand : m_Hands)
-		{
-			optimalHand.push_back(GetOptimalHand(hand));
-		}
-
-		std::sort(optimalHand.begin(), optimalHand.end(), CompareHandPred(true));
-
-		uint64_t sum = 0;
-		char cardBuffer[6] = { 0 };
-		for (size_t i = 0; i < optimalHand.size(); ++i)
-		{
-			memcpy(cardBuffer, optimalHand[i].cards, 5);
-			Log("Rank %zd: Card %s resolved to result %s with a bet of %u.", i + 1, cardBuffer, HandResultAsString[static_cast<uint32_t>(optimalHand[i].result)], optimalHand[i].bet);
-			sum += (optimalHand[i].bet * (i + 1));
-		}
+		const uint64_t sum = GetTotalWinnings([](const Hand& hand) { return hand.jokerKey; });
 
-		Log("Total Optimal Sum = %u", sum);
+		Log("Total Optimal Sum = %" PRIu64, sum);
 
 		// Done.
 		AdventGUIInstance::PartTwo(context);
@@ -3,69 +3,44 @@
 
 #include "AdventGUI/AdventGUI.h"
 
-#include "ACUtils/Hash.h"
 #include "ACUtils/Math.h"
 #include "ACUtils/StringUtil.h"
 #include <algorithm>
+#include <inttypes.h>
 #include <vector>
 #include <unordered_map>
 
-
-struct DesertNode
-{
-	DesertNode() : m_RawName(), m_Hash(0), m_Destinations{}, m_DestinationHashes{ 0, 0 } {}
-	DesertNode(const std::string& _rawName, const std::string& _leftName, const std::string& _rightName)
-		: m_RawName(_rawName),
-		m_Hash(Hash::HashString32(_rawName.c_str())),
-		m_Destinations{ _leftName, _rightName },
-		m_DestinationHashes{ Hash::HashString32(_leftName.c_str()), Hash::HashString32(_rightName.c_str()) }
-	{
-	}
-
-	bool operator==(const DesertNode& RHS) const
-	{
-		return m_Hash == RHS.m_Hash && 
-		m_DestinationHashes[0] == RHS.m_DestinationHashes[0] &&
-		m_DestinationHashes[1] == RHS.m_DestinationHashes[1];
-	}
-	bool operator!=(const DesertNode& RHS) const
-	{
-		return m_Hash != RHS.m_Hash ||
-			m_DestinationHashes[0] != RHS.m_DestinationHashes[0] ||
-			m_DestinationHashes[1] != RHS.m_DestinationHashes[1];
-	}
-
-	std::string m_RawName;
-	uint32_t m_Hash;
-	std::string m_Destinations[2];
-	uint32_t m_DestinationHashes[2];
-};
-
-namespace std 
-{
-	template<>struct hash<DesertNode>
-	{
-		std::size_t operator()(DesertNode const& val) const
-		{
-			return val.m_Hash;
-		}
-	}; 
-}
-
 class AdventDay : public AdventGUIInstance
 {
 public:
 	AdventDay(const AdventGUIParams& params) : AdventGUIInstance(params) {};
 
 private:
+	static constexpr uint32_t INVALID_NODE = ~0U;
 
+	uint32_t GetNodeIndex(const std::string& name)
+	{
+		const std::pair<std::unordered_map<std::string, uint32_t>::iterator, bool> result = m_NodeIndices.emplace(name, (uint32_t)m_NodeNames.size());
+		if (result.second)
+		{
+			m_NodeNames.push_back(name);
+			m_Next.push_back(INVALID_NODE);
+			m_Next.push_back(INVALID_NODE);
+		}
+		return result.first->second;
+	}
 
 	virtual void ParseInput(FileStreamReader& fileReader) override
 	{
 		// Parse Input. Input never changes between parts of a problem.
 		assert(!fileReader.IsEOF());
-		m_Steps = fileReader.ReadLine();
-		assert(m_Steps.size() != 0);
+		const std::string steps = fileReader.ReadLine();
+		assert(steps.size() != 0);
+		for (char c : steps)
+		{
+			assert(c == 'L' || c == 'R');
+			m_Steps.push_back(c == 'L' ? 0 : 1);
+		}
 		
 		std::string line;
 		std::vector<std::string> tokens;
@@ -77,103 +52,226 @@ private:
 				continue;
 			}
 
+			// "AAA = (BBB, CCC)"
 			StringUtil::SplitBy(line, " ", tokens);
 			assert(tokens.size() == 4);
-			DesertNode newNode(tokens[0], tokens[2].substr(1, 3), tokens[3].substr(0, 3));
-			m_Nodes.emplace(std::make_pair(newNode.m_Hash, newNode));
+			const uint32_t node = GetNodeIndex(tokens[0]);
+			const uint32_t left = GetNodeIndex(tokens[2].substr(1, 3));
+			const uint32_t right = GetNodeIndex(tokens[3].substr(0, 3));
+			m_Next[node * 2] = left;
+			m_Next[node * 2 + 1] = right;
+		}
+
+		// Where each node ends up after one full pass of the instructions, and when it's sitting on a **Z along the way.
+		const uint32_t nodeCount = (uint32_t)m_NodeNames.size();
+		m_PassEnd.resize(nodeCount);
+		m_PassHitStart.resize(nodeCount + 1);
+		m_PassHitOffsets.clear();
+		for (uint32_t node = 0; node < nodeCount; ++node)
+		{
+			assert(m_Next[node * 2] != INVALID_NODE && m_Next[node * 2 + 1] != INVALID_NODE); // Every node should be defined.
 
-			if (newNode.m_RawName[2] == 'A')
+			m_PassHitStart[node] = (uint32_t)m_PassHitOffsets.size();
+			uint32_t current = node;
+			for (uint32_t step = 0; step < (uint32_t)m_Steps.size(); ++step)
 			{
-				m_StartingNodes.push_back(newNode.m_Hash);
+				if (IsEndNode(current))
+				{
+					m_PassHitOffsets.push_back(step);
+				}
+				current = m_Next[current * 2 + m_Steps[step]];
 			}
+			m_PassEnd[node] = current;
 		}
+		m_PassHitStart[nodeCount] = (uint32_t)m_PassHitOffsets.size();
 	}
 
+	bool IsEndNode(uint32_t node) const { return m_NodeNames[node][2] == 'Z'; }
+
 	virtual void PartOne(const AdventGUIContext& context) override
 	{
 		// Part One
+		const std::unordered_map<std::string, uint32_t>::const_iterator itStart = m_NodeIndices.find("AAA");
+		const std::unordered_map<std::string, uint32_t>::const_iterator itExit = m_NodeIndices.find("ZZZ");
+		assert(itStart != m_NodeIndices.end() && itExit != m_NodeIndices.end());
+
 		uint64_t totalSteps = 0;
-		uint32_t nextIndex = 0;
-		uint32_t currentHash = m_StartHash;
-		std::unordered_map<uint32_t, DesertNode>::const_iterator itFind = m_Nodes.end();
-		while (currentHash != m_ExitHash)
+		uint32_t current = itStart->second;
+		while (current != itExit->second)
 		{
-			itFind = m_Nodes.find(currentHash);
-			assert(itFind != m_Nodes.end());
-			nextIndex = m_Steps[totalSteps % m_Steps.size()] == 'L' ? 0 : 1;
-			currentHash = itFind->second.m_DestinationHashes[nextIndex];
+			current = m_Next[current * 2 + m_Steps[totalSteps % m_Steps.size()]];
 			++totalSteps;
 		}
 
-		Log("Route took %u steps.", totalSteps);
+		Log("Route took %" PRIu64 " steps.", totalSteps);
 
 		// Done.
 		AdventGUIInstance::PartOne(context);
 	}
 
-	virtual void PartTwo(const AdventGUIContext& context) override
+	// When one ghost is on a **Z. Steps before tailSteps are one offs, after that the walk repeats every period steps.
+	struct GhostLane
 	{
-		// Part Two
-		std::vector<uint32_t> successTotalHistory;
-		uint64_t totalSteps = 0;
-		uint32_t iterationSteps =0;
-		uint32_t nextIndex = 0;
-		std::unordered_map<uint32_t, DesertNode>::const_iterator itFind = m_Nodes.end();
-		for (uint32_t startNode : m_StartingNodes)
+		uint64_t tailSteps = 0;
+		uint64_t period = 0;
+		std::vector<uint64_t> tailHits; // Sorted steps < tailSteps
+		std::vector<uint64_t> cycleResidues; // Sorted (step - tailSteps) % period
+	};
+
+	// At pass boundaries the only state is the node, so jump a whole pass at a time until a node repeats.
+	void AnalyzeLane(uint32_t startNode, GhostLane& outLane) const
+	{
+		const uint64_t passLength = m_Steps.size();
+		std::vector<uint32_t> firstSeenPass(m_NodeNames.size(), INVALID_NODE);
+		std::vector<uint32_t> passNodes;
+
+		uint32_t current = startNode;
+		while (firstSeenPass[current] == INVALID_NODE)
 		{
-			totalSteps = 0;
-			uint32_t currentNode = startNode;
-			while (true)
+			firstSeenPass[current] = (uint32_t)passNodes.size();
+			passNodes.push_back(current);
+			current = m_PassEnd[current];
+		}
+
+		const uint32_t tailPasses = firstSeenPass[current];
+		outLane.tailSteps = tailPasses * passLength;
+		outLane.period = (passNodes.size() - tailPasses) * passLength;
+		outLane.tailHits.clear();
+		outLane.cycleResidues.clear();
+		for (uint32_t pass = 0; pass < (uint32_t)passNodes.size(); ++pass)
+		{
+			const uint32_t node = passNodes[pass];
+			for (uint32_t hit = m_PassHitStart[node]; hit < m_PassHitStart[node + 1]; ++hit)
 			{
-				itFind = m_Nodes.find(currentNode);
-				assert(itFind != m_Nodes.end());
-				nextIndex = m_Steps[totalSteps % m_Steps.size()] == 'L' ? 0 : 1;
-				if (itFind->second.m_RawName[2] == 'Z')
+				const uint64_t step = pass * passLength + m_PassHitOffsets[hit];
+				if (pass < tailPasses)
+				{
+					outLane.tailHits.push_back(step);
+				}
+				else
 				{
-					Log("Node %u success after %u steps", startNode, totalSteps);
-					successTotalHistory.push_back((uint32_t)totalSteps);
-					break;
+					outLane.cycleResidues.push_back(step - outLane.tailSteps);
 				}
-				currentNode = itFind->second.m_DestinationHashes[nextIndex];
-				++totalSteps;
 			}
+		}
+	}
 
+	bool IsLaneOnEnd(const GhostLane& lane, uint64_t step) const
+	{
+		if (step < lane.tailSteps)
+		{
+			return std::binary_search(lane.tailHits.begin(), lane.tailHits.end(), step);
 		}
+		return std::binary_search(lane.cycleResidues.begin(), lane.cycleResidues.end(), (step - lane.tailSteps) % lane.period);
+	}
 
-		std::vector<uint32_t> primeFactors;
-		std::vector<uint32_t> conjoinedFactors;
-		uint64_t LCM = 1;
+	// First step with every lane on a **Z, or 0 if there isn't one (or it doesn't fit in 64 bits).
+	uint64_t FindFirstCommonStep(const std::vector<GhostLane>& lanes) const
+	{
+		// Inside the longest tail that lane can only be on one of its tail hits, so those are the only candidates.
+		const GhostLane* longestTail = &lanes[0];
+		for (const GhostLane& lane : lanes)
+		{
+			longestTail = lane.tailSteps > longestTail->tailSteps ? &lane : longestTail;
+		}
+
+		for (uint64_t step : longestTail->tailHits)
+		{
+			bool allOnEnd = true;
+			for (const GhostLane& lane : lanes)
+			{
+				allOnEnd &= IsLaneOnEnd(lane, step);
+			}
+
+			if (allOnEnd)
+			{
+				return step;
+			}
+		}
+
+		// Past every tail it's periodic, CRT over every combination of residues. Usually there's exactly one per lane.
+		const uint64_t minStep = longestTail->tailSteps;
+		uint64_t best = 0;
+		std::vector<uint32_t> choice(lanes.size(), 0);
+		for (const GhostLane& lane : lanes)
+		{
+			if (lane.cycleResidues.empty())
+			{
+				return 0; // Never on a **Z again.
+			}
+		}
 
-		assert(successTotalHistory.size() < 16);
-		for (uint32_t success : successTotalHistory)
+		while (true)
 		{
-			Math::PrimeFactorization32(success, primeFactors);
-			Log("Prime Factors for %u:", success);
+			uint64_t a = 0;
+			uint64_t m = 1;
+			bool consistent = true;
+			for (size_t i = 0; i < lanes.size() && consistent; ++i)
+			{
+				const GhostLane& lane = lanes[i];
+				consistent = Math::CombineCongruences(a, m, (lane.tailSteps + lane.cycleResidues[choice[i]]) % lane.period, lane.period, a, m);
+			}
 
-			for (uint32_t prime : primeFactors)
+			if (consistent)
 			{
-				Log("\t %u", prime);
-				if (std::find(conjoinedFactors.begin(), conjoinedFactors.end(), prime) == conjoinedFactors.end())
+				uint64_t step = a;
+				if (step < minStep)
 				{
-					conjoinedFactors.push_back(prime);
-					LCM *= prime;
+					step += ((minStep - step + m - 1) / m) * m;
 				}
+				best = best == 0 ? step : std::min(best, step);
+			}
+
+			// Next combination.
+			size_t digit = 0;
+			while (digit < lanes.size() && ++choice[digit] == lanes[digit].cycleResidues.size())
+			{
+				choice[digit++] = 0;
+			}
+
+			if (digit == lanes.size())
+			{
+				break;
 			}
 		}
 
-		Log("Total Steps = %llu", LCM);
+		return best;
+	}
+
+	virtual void PartTwo(const AdventGUIContext& context) override
+	{
+		// Part Two
+		std::vector<GhostLane> lanes;
+		for (uint32_t node = 0; node < (uint32_t)m_NodeNames.size(); ++node)
+		{
+			if (m_NodeNames[node][2] == 'A')
+			{
+				lanes.emplace_back();
+				AnalyzeLane(node, lanes.back());
+				Log("Ghost %s: tail %" PRIu64 " steps, period %" PRIu64 " steps, %zd hits in the loop", m_NodeNames[node].c_str(), lanes.back().tailSteps, lanes.back().period, lanes.back().cycleResidues.size());
+			}
+		}
+		assert(!lanes.empty());
+
+		Log("Total Steps = %" PRIu64, FindFirstCommonStep(lanes));
 
 		// Done.
 		AdventGUIInstance::PartTwo(context);
 	}
-	std::string m_Steps;
-	std::unordered_map<uint32_t, DesertNode> m_Nodes;
-	std::vector<uint32_t> m_StartingNodes;
-	static constexpr uint32_t m_StartHash = Hash::HashString32("AAA");
-	static constexpr uint32_t m_ExitHash = Hash::HashString32("ZZZ");
-	
+
+	std::vector<uint8_t> m_Steps; // 0 = L, 1 = R
+	std::unordered_map<std::string, uint32_t> m_NodeIndices;
+	std::vector<std::string> m_NodeNames;
+	std::vector<uint32_t> m_Next; // [node * 2 + step]
+
+	// After a full pass of m_Steps from each node.
+	std::vector<uint32_t> m_PassEnd;
+	std::vector<uint32_t> m_PassHitStart; // CSR into m_PassHitOffsets
+	std::vector<uint32_t> m_PassHitOffsets; // Steps into the pass where we're on a **Z
 };
 
+constexpr uint32_t AdventDay::INVALID_NODE;
+
 int main()
 {
 	AdventGUIParams newParams;
@@ -3,7 +3,9 @@
 
 #include "AdventGUI/AdventGUI.h"
 
+#include "ACUtils/Math.h"
 #include "ACUtils/StringUtil.h"
+#include <climits>
 #include <inttypes.h>
 #include <vector>
 
@@ -12,13 +14,15 @@ class AdventDay : public AdventGUIInstance
 public:
 	AdventDay(const AdventGUIParams& params) : AdventGUIInstance(params) {};
 
-	struct NumberTree
+private:
+	// All the histories with the same number of readings, flat and row major.
+	struct HistoryGroup
 	{
-		std::vector<int64_t> m_Values;
-		NumberTree* m_Parent = nullptr;
-		NumberTree* m_Child = nullptr;
+		uint32_t length = 0;
+		bool fitsInt32 = true;
+		std::vector<int64_t> values; // [history * length + reading]
 	};
-private:
+
 	virtual void ParseInput(FileStreamReader& fileReader) override
 	{
 		// Parse Input. Input never changes between parts of a problem.
@@ -27,108 +31,95 @@ private:
 		while (!fileReader.IsEOF())
 		{
 			line = fileReader.ReadLine();
-			assert(line.size() != 0);
-			StringUtil::SplitBy(line, " ", tokens);
-			NumberTree* newTree = new NumberTree();
-			for (const std::string& token : tokens)
+			if (line.size() == 0)
 			{
-				newTree->m_Values.push_back(StringUtil::AtoiI64(token.c_str()));
+				continue;
 			}
 
-			SolveTree(newTree);
-
-			m_Trees.push_back(newTree);
-		}
-	}
+			StringUtil::SplitBy(line, " ", tokens);
+			assert(!tokens.empty());
 
-	void SolveTree(NumberTree* currentTree) const
-	{
-		std::vector<int64_t> diffs;
-		diffs.reserve(currentTree->m_Values.size() - 1);
-		bool allZero = true;
-		int64_t delta = 0;
-		for (size_t i = 0; i < currentTree->m_Values.size() - 1; ++i)
-		{
-			delta = currentTree->m_Values[i + 1] - currentTree->m_Values[i];
-			diffs.push_back(delta);
-			allZero &= (delta == 0);
+			HistoryGroup& group = GetGroup((uint32_t)tokens.size());
+			for (const std::string& token : tokens)
+			{
+				const int64_t value = StringUtil::AtoiI64(token.c_str());
+				group.fitsInt32 &= value >= INT32_MIN && value <= INT32_MAX;
+				group.values.push_back(value);
+			}
 		}
 
-		NumberTree* Leaf = new NumberTree();
-		Leaf->m_Values = std::move(diffs);
-		Leaf->m_Parent = currentTree;
-		currentTree->m_Child = Leaf;
-
-		if (!allZero)
-		{
-			SolveTree(Leaf);
-		}
+		SolveHistories();
 	}
 
-	int64_t GetExtrapolatedSum(const NumberTree* tree) const
+	HistoryGroup& GetGroup(uint32_t length)
 	{
-		if (tree->m_Child)
+		for (HistoryGroup& group : m_Groups)
 		{
-			return tree->m_Values.back() + GetExtrapolatedSum(tree->m_Child);
+			if (group.length == length)
+			{
+				return group;
+			}
 		}
 
-		return tree->m_Values.back();
+		m_Groups.emplace_back();
+		m_Groups.back().length = length;
+		return m_Groups.back();
 	}
 
-	int64_t GetReverseExtrapolatedSum(const NumberTree* tree) const
+	// Every history is a polynomial of degree < its length, so the next / previous values are fixed binomial weightings of
+	// the readings. Weights once per length, then the whole group goes through the SSE batch when it safely can.
+	void SolveHistories()
 	{
-		if (tree->m_Child)
+		m_NextSum = 0;
+		m_PreviousSum = 0;
+
+		std::vector<int64_t> weights;
+		std::vector<int32_t> columns;
+		std::vector<int64_t> nextValues;
+		std::vector<int64_t> previousValues;
+		for (const HistoryGroup& group : m_Groups)
 		{
-			return tree->m_Values.front() - GetReverseExtrapolatedSum(tree->m_Child);
-		}
-
-		return tree->m_Values.front();
-	}
+			const size_t historyCount = group.values.size() / group.length;
+			Math::GetExtrapolationWeights(group.length, weights);
+			nextValues.resize(historyCount);
+			previousValues.resize(historyCount);
 
-	void PrintTree(const NumberTree* tree)
-	{
-		char displayBuffer[256] = { 0 };
-		for (size_t i = 0; i < tree->m_Values.size(); ++i)
-		{
-			if (i == 0)
+			bool solved = false;
+			if (group.fitsInt32)
 			{
-				sprintf_s(displayBuffer, 256, "%" PRId64, tree->m_Values[i]);
+				columns.resize(group.values.size());
+				for (size_t history = 0; history < historyCount; ++history)
+				{
+					for (uint32_t reading = 0; reading < group.length; ++reading)
+					{
+						columns[reading * historyCount + history] = (int32_t)group.values[history * group.length + reading];
+					}
+				}
+
+				solved = Math::ExtrapolateBatch(columns.data(), group.length, historyCount, weights, nextValues.data(), previousValues.data());
 			}
-			else
+
+			if (!solved)
 			{
-				sprintf_s(displayBuffer, 256, "%s %" PRId64, displayBuffer, tree->m_Values[i]);
+				for (size_t history = 0; history < historyCount; ++history)
+				{
+					const bool fits = Math::ExtrapolateChecked(&group.values[history * group.length], group.length, weights, nextValues[history], previousValues[history]);
+					assert(fits);
+				}
 			}
-		}
 
-		if (tree->m_Parent != nullptr)
-		{
-			int depth = 0;
-			const NumberTree* current = tree->m_Parent;
-			while (current)
+			for (size_t history = 0; history < historyCount; ++history)
 			{
-				sprintf_s(displayBuffer, 256, " %s", displayBuffer);
-				current = current->m_Parent;
+				m_NextSum += nextValues[history];
+				m_PreviousSum += previousValues[history];
 			}
 		}
-
-		Log("%s", displayBuffer);
-
-		if (tree->m_Child)
-		{
-			PrintTree(tree->m_Child);
-		}
 	}
 
 	virtual void PartOne(const AdventGUIContext& context) override
 	{
 		// Part One
-		int64_t sum = 0;
-		for (NumberTree* tree : m_Trees)
-		{
-			sum += GetExtrapolatedSum(tree);
-		}
-
-		Log("Total Sum = %" PRId64, sum);
+		Log("Total Sum = %" PRId64, m_NextSum);
 
 		// Done.
 		AdventGUIInstance::PartOne(context);
@@ -137,19 +128,15 @@ private:
 	virtual void PartTwo(const AdventGUIContext& context) override
 	{
 		// Part Two
-		int64_t sum = 0;
-		for (NumberTree* tree : m_Trees)
-		{
-			sum += GetReverseExtrapolatedSum(tree);
-		}
-
-		Log("Total Reversed Sum = %" PRId64, sum);
+		Log("Total Reversed Sum = %" PRId64, m_PreviousSum);
 
 		// Done.
 		AdventGUIInstance::PartTwo(context);
 	}
 
-	std::vector<NumberTree*> m_Trees;
+	std::vector<HistoryGroup> m_Groups;
+	int64_t m_NextSum = 0;
+	int64_t m_PreviousSum = 0;
 };
 
 int main()